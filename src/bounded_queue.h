@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+// Depth of a BoundedQueue seen by pushes
+struct BoundedQueueStats {
+    size_t capacity = 0;
+    size_t push_count = 0;
+    size_t max_depth = 0;
+    double average_depth = 0.0;
+    // Pushes which waited for a free place
+    size_t blocked_push_count = 0;
+};
+
+// Queue between two stages of a pipeline. Push blocks while the queue is
+// full, so a fast producer is held back by a slow consumer, and Pop blocks
+// while it is empty until the queue is closed.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity)
+    {
+        if (capacity == 0)
+            throw std::invalid_argument("zero capacity of a queue");
+    }
+
+    // Returns false if the queue is closed
+    bool Push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.size() == capacity_ && !is_closed_)
+            ++blocked_push_count_;
+        not_full_.wait(lock, [this] {
+            return queue_.size() < capacity_ || is_closed_;
+        });
+        if (is_closed_)
+            return false;
+
+        queue_.push_back(std::move(value));
+        ++push_count_;
+        depth_sum_ += queue_.size();
+        max_depth_ = std::max(max_depth_, queue_.size());
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Nothing once the queue is closed and empty
+    std::optional<T> Pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] {
+            return !queue_.empty() || is_closed_;
+        });
+        if (queue_.empty())
+            return std::nullopt;
+
+        std::optional<T> value = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    // Wakes up all waiting threads: pushes fail from now on,
+    // and pops return the values left
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    BoundedQueueStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {
+            capacity_,
+            push_count_,
+            max_depth_,
+            push_count_ ? static_cast<double>(depth_sum_)/push_count_ : 0.0,
+            blocked_push_count_
+        };
+    }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> queue_;
+    bool is_closed_ = false;
+
+    size_t push_count_ = 0;
+    size_t depth_sum_ = 0;
+    size_t max_depth_ = 0;
+    size_t blocked_push_count_ = 0;
+};
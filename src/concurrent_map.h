@@ -32,7 +32,9 @@ public:
         {
         }
 
-        operator Value&();
+        inline operator Value&() {
+            return ref_to_value;
+        }
 
         std::lock_guard<std::mutex> lock;
         Value& ref_to_value;
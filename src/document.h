@@ -1,4 +1,6 @@
 #pragma once
+#include <string_view>
+#include <vector>
 
 enum class DocumentStatus {
     ACTUAL,
@@ -20,3 +22,10 @@ struct Document {
     double relevance = 0.0;
     int rating = 0;
 };
+
+struct RawDocument {
+    int id = 0;
+    std::string_view text;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
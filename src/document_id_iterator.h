@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Forward iterator over the ids of a document table in order of addition,
+// skipping the holes (negative ids) left by removed documents
+class DocumentIdIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = const int&;
+
+    using Base = std::vector<int>::const_iterator;
+
+    DocumentIdIterator() = default;
+
+    DocumentIdIterator(Base it, Base end)
+        : it_(it)
+        , end_(end)
+    {
+        SkipHoles();
+    }
+
+    inline reference operator*() const {
+        return *it_;
+    }
+
+    inline pointer operator->() const {
+        return &*it_;
+    }
+
+    inline DocumentIdIterator& operator++() {
+        ++it_;
+        SkipHoles();
+        return *this;
+    }
+
+    inline DocumentIdIterator operator++(int) {
+        DocumentIdIterator it = *this;
+        ++*this;
+        return it;
+    }
+
+    inline bool operator==(const DocumentIdIterator& other) const {
+        return it_ == other.it_;
+    }
+
+    inline bool operator!=(const DocumentIdIterator& other) const {
+        return it_ != other.it_;
+    }
+
+private:
+    Base it_;
+    Base end_;
+
+    inline void SkipHoles() {
+        while (it_ != end_ && *it_ < 0)
+            ++it_;
+    }
+};
@@ -0,0 +1,170 @@
+#include "document_loader.h"
+
+DocumentLoader::DocumentLoader(SearchServer& search_server, const Options& options)
+    : search_server_(search_server)
+    , options_(options)
+{
+    if (options.chunk_size == 0 || options.queue_capacity == 0)
+        throw std::invalid_argument("zero chunk size or queue capacity of a loader");
+}
+
+DocumentLoader::Stats DocumentLoader::Load(std::istream& in) {
+    BoundedQueue<std::unique_ptr<const std::string>> chunks(options_.queue_capacity);
+    BoundedQueue<Batch> batches(options_.queue_capacity);
+
+    // The first failure of a stage stops the whole pipeline
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    const auto run_stage = [&](auto stage) {
+        try {
+            stage();
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            chunks.Close();
+            batches.Close();
+        }
+    };
+
+    Stats stats;
+    const auto start_time = std::chrono::steady_clock::now();
+    std::thread reader([&] {
+        run_stage([&] { ReadChunks(in, chunks); });
+        chunks.Close();
+    });
+    std::thread tokenizer([&] {
+        run_stage([&] { TokenizeChunks(chunks, batches); });
+        batches.Close();
+    });
+    run_stage([&] {
+        while (std::optional<Batch> batch = batches.Pop()) {
+            search_server_.ThrowInvalidDocumentIds(batch->documents);
+            search_server_.IndexDocuments(batch->documents, batch->tokenized_documents);
+            stats.document_count += batch->documents.size();
+        }
+    });
+    reader.join();
+    tokenizer.join();
+    if (error)
+        std::rethrow_exception(error);
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+    stats.seconds = duration.count();
+    stats.documents_per_second = stats.seconds > 0.0 ? stats.document_count/stats.seconds : 0.0;
+    stats.chunk_queue = chunks.GetStats();
+    stats.batch_queue = batches.GetStats();
+    return stats;
+}
+
+DocumentLoader::Stats DocumentLoader::Load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::system_error(errno, std::generic_category(), path);
+    return Load(in);
+}
+
+RawDocument DocumentLoader::ParseRecord(std::string_view line) {
+    std::string_view fields[3];
+    std::string_view rest = line;
+    for (std::string_view& field : fields) {
+        const size_t tab = rest.find('\t');
+        if (tab == rest.npos)
+            throw std::invalid_argument(
+                "invalid document record --> [" + std::string(line) + ']'
+            );
+        field = rest.substr(0, tab);
+        rest.remove_prefix(tab + 1);
+    }
+
+    RawDocument document;
+    document.id = ParseNumber(fields[0], line);
+    document.text = rest;
+
+    const int status = ParseNumber(fields[1], line);
+    if (status < static_cast<int>(DocumentStatus::ACTUAL)
+        || status > static_cast<int>(DocumentStatus::REMOVED))
+        throw std::invalid_argument(
+            "invalid document status --> [" + std::string(line) + ']'
+        );
+    document.status = static_cast<DocumentStatus>(status);
+
+    ForEachWord(fields[2], [&document, line](std::string_view rating) {
+        document.ratings.push_back(ParseNumber(rating, line));
+    });
+    return document;
+}
+
+void DocumentLoader::ReadChunks(
+    std::istream& in,
+    BoundedQueue<std::unique_ptr<const std::string>>& chunks
+) const
+{
+    // A line cut by the end of a chunk is carried over to the next one
+    std::string carried_line;
+    while (in) {
+        auto chunk = std::make_unique<std::string>(std::move(carried_line));
+        carried_line.clear();
+
+        const size_t carried_size = chunk->size();
+        chunk->resize(carried_size + options_.chunk_size);
+        in.read(chunk->data() + carried_size, options_.chunk_size);
+        chunk->resize(carried_size + in.gcount());
+
+        if (in) {
+            const size_t last_line_end = chunk->rfind('\n');
+            if (last_line_end == chunk->npos) {
+                carried_line = std::move(*chunk);
+                continue;
+            }
+            carried_line.assign(chunk->begin() + last_line_end + 1, chunk->end());
+            chunk->resize(last_line_end + 1);
+        }
+
+        if (!chunk->empty() && !chunks.Push(std::move(chunk)))
+            return;
+    }
+    if (in.bad())
+        throw std::runtime_error("cannot read documents");
+}
+
+void DocumentLoader::TokenizeChunks(
+    BoundedQueue<std::unique_ptr<const std::string>>& chunks,
+    BoundedQueue<Batch>& batches
+) const
+{
+    while (std::optional<std::unique_ptr<const std::string>> chunk = chunks.Pop()) {
+        Batch batch;
+        batch.chunk = std::move(*chunk);
+
+        std::string_view text = *batch.chunk;
+        while (!text.empty()) {
+            const size_t line_end = text.find('\n');
+            std::string_view line = text.substr(0, line_end);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (!line.empty())
+                batch.documents.push_back(ParseRecord(line));
+            if (line_end == text.npos)
+                break;
+            text.remove_prefix(line_end + 1);
+        }
+
+        batch.tokenized_documents = search_server_.TokenizeDocuments(std::execution::par,
+                                                                     batch.documents);
+        if (!batches.Push(std::move(batch)))
+            return;
+    }
+}
+
+int DocumentLoader::ParseNumber(std::string_view text, std::string_view line) {
+    int number = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    if (error != std::errc() || end != text.data() + text.size() || text.empty())
+        throw std::invalid_argument(
+            "invalid number in document record --> [" + std::string(line) + ']'
+        );
+    return number;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <execution>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "document.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+// Streams line-delimited document records into a SearchServer through
+// a pipeline of three stages on their own threads: the reader cuts the
+// input into large chunks of whole lines, the tokenizer parses records of a
+// chunk and tokenizes them in parallel, and the calling thread indexes the
+// tokenized batches. Stages are connected by bounded queues, so a slow
+// stage holds back the previous one and memory use doesn't grow with the
+// input.
+//
+// A record is "id<TAB>status<TAB>ratings<TAB>text", where status is the
+// number of a DocumentStatus and ratings are separated by spaces. If a
+// record is invalid, Load throws once the batches before it are indexed.
+class DocumentLoader {
+public:
+    struct Options {
+        size_t chunk_size = 1 << 20;
+        size_t queue_capacity = 4;
+    };
+
+    struct Stats {
+        size_t document_count = 0;
+        double seconds = 0.0;
+        double documents_per_second = 0.0;
+        // Chunks waiting for the tokenizer
+        BoundedQueueStats chunk_queue;
+        // Tokenized batches waiting for the indexer
+        BoundedQueueStats batch_queue;
+    };
+
+    explicit DocumentLoader(SearchServer& search_server)
+        : DocumentLoader(search_server, Options())
+    {
+    }
+
+    DocumentLoader(SearchServer& search_server, const Options& options);
+
+    Stats Load(std::istream& in);
+
+    Stats Load(const std::string& path);
+
+    // Document of a record, whose text is a view of the line
+    static RawDocument ParseRecord(std::string_view line);
+
+private:
+    struct Batch {
+        std::unique_ptr<const std::string> chunk;
+        std::vector<RawDocument> documents;
+        std::vector<SearchServer::TokenizedDocument> tokenized_documents;
+    };
+
+    SearchServer& search_server_;
+    const Options options_;
+
+    void ReadChunks(std::istream& in,
+                    BoundedQueue<std::unique_ptr<const std::string>>& chunks) const;
+
+    void TokenizeChunks(BoundedQueue<std::unique_ptr<const std::string>>& chunks,
+                        BoundedQueue<Batch>& batches) const;
+
+    static int ParseNumber(std::string_view text, std::string_view line);
+};
@@ -0,0 +1,33 @@
+#include "index_file.h"
+
+IndexFileLayout ComputeIndexFileLayout(const IndexFileHeader& header) {
+    IndexFileLayout layout;
+    size_t offset = AlignIndexFileSize(sizeof(IndexFileHeader));
+    const auto add_section = [&offset](size_t size) {
+        const size_t section = offset;
+        offset += AlignIndexFileSize(size);
+        return section;
+    };
+
+    layout.stop_words = add_section(header.stop_words_size);
+    layout.term_word_offsets = add_section((header.term_count + 1)*sizeof(uint64_t));
+    layout.words = add_section(header.words_size);
+    layout.term_posting_offsets = add_section((header.term_count + 1)*sizeof(uint64_t));
+    layout.posting_ordinals = add_section(header.posting_count*sizeof(int32_t));
+    layout.posting_term_freqs = add_section(header.posting_count*sizeof(double));
+    layout.document_ids = add_section(header.document_count*sizeof(int32_t));
+    layout.document_statuses = add_section(header.document_count*sizeof(int32_t));
+    layout.document_ratings = add_section(header.document_count*sizeof(int32_t));
+    layout.document_term_offsets = add_section((header.document_count + 1)*sizeof(uint64_t));
+    layout.document_terms = add_section(header.posting_count*sizeof(int32_t));
+    layout.file_size = offset;
+    return layout;
+}
+
+uint64_t ComputeIndexFileChecksum(const char* data, size_t size, uint64_t checksum) {
+    for (size_t i = 0; i < size; ++i) {
+        checksum ^= static_cast<unsigned char>(data[i]);
+        checksum *= 0x100000001b3;
+    }
+    return checksum;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Binary index file written by SearchServer::Save and memory-mapped by
+// MappedSearchServer. The header is followed by the sections of
+// IndexFileLayout in order, each padded to INDEX_FILE_ALIGNMENT bytes.
+// Numbers are stored in the native byte order.
+//
+// Terms are ordered by word and documents by id, so both are looked up by
+// a binary search in the mapping. Term ids are positions in the term order
+// and ordinals are positions in the document order.
+const char INDEX_FILE_MAGIC[8] = {'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0'};
+const uint32_t INDEX_FILE_VERSION = 1;
+const size_t INDEX_FILE_ALIGNMENT = 8;
+
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    // Checksum of everything after the header
+    uint64_t checksum;
+    uint64_t document_count;
+    uint64_t term_count;
+    uint64_t posting_count;
+    uint64_t stop_words_size;
+    uint64_t words_size;
+};
+
+// Offsets of sections from the start of the file
+struct IndexFileLayout {
+    // Stop words separated by spaces
+    size_t stop_words;
+    // term_count + 1 offsets of words in the words section
+    size_t term_word_offsets;
+    size_t words;
+    // term_count + 1 offsets of postings of terms
+    size_t term_posting_offsets;
+    // Postings of a term sorted by ordinal
+    size_t posting_ordinals;
+    size_t posting_term_freqs;
+    // Sorted ids, statuses and ratings of documents by ordinal
+    size_t document_ids;
+    size_t document_statuses;
+    size_t document_ratings;
+    // document_count + 1 offsets of terms of documents
+    size_t document_term_offsets;
+    // Terms of a document sorted by term id
+    size_t document_terms;
+    size_t file_size;
+};
+
+inline size_t AlignIndexFileSize(size_t size) {
+    return (size + INDEX_FILE_ALIGNMENT - 1)/INDEX_FILE_ALIGNMENT*INDEX_FILE_ALIGNMENT;
+}
+
+IndexFileLayout ComputeIndexFileLayout(const IndexFileHeader& header);
+
+// FNV-1a hash of data continuing the hash of the preceding bytes
+uint64_t ComputeIndexFileChecksum(const char* data, size_t size,
+                                  uint64_t checksum = 0xcbf29ce484222325);
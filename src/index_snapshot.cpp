@@ -0,0 +1,231 @@
+#include "index_snapshot.h"
+
+IndexSnapshot::IndexSnapshot(std::shared_ptr<const SearchServer> parser)
+    : parser_(std::move(parser))
+{
+}
+
+bool IndexSnapshot::HasDocument(int document_id) const {
+    return FindSegment(document_id) != segments_.size();
+}
+
+std::shared_ptr<const IndexSnapshot> IndexSnapshot::AddSegment(
+    std::shared_ptr<const SearchServer> segment
+) const
+{
+    auto snapshot = std::make_shared<IndexSnapshot>(*this);
+    snapshot->document_count_ += segment->GetDocumentCount();
+    if (segment->GetDocumentCount())
+        snapshot->segments_.push_back({std::move(segment), nullptr});
+    return snapshot;
+}
+
+std::shared_ptr<const IndexSnapshot> IndexSnapshot::RemoveDocuments(
+    const std::vector<int>& document_ids
+) const
+{
+    // Removed ids of every segment
+    std::vector<std::vector<int>> segment_document_ids(segments_.size());
+    for (const int document_id : document_ids) {
+        const size_t segment = FindSegment(document_id);
+        if (segment != segments_.size())
+            segment_document_ids[segment].push_back(document_id);
+    }
+
+    auto snapshot = std::make_shared<IndexSnapshot>(parser_);
+    snapshot->document_count_ = document_count_;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        std::vector<int>& removed_ids = segment_document_ids[i];
+        std::sort(removed_ids.begin(), removed_ids.end());
+        removed_ids.erase(std::unique(removed_ids.begin(), removed_ids.end()),
+                          removed_ids.end());
+        if (removed_ids.empty()) {
+            snapshot->segments_.push_back(segments_[i]);
+            continue;
+        }
+
+        snapshot->document_count_ -= removed_ids.size();
+        Segment segment = segments_[i].RemoveDocuments(removed_ids);
+        // A segment without live documents is dropped
+        if (segment.GetLiveDocumentCount())
+            snapshot->segments_.push_back(std::move(segment));
+    }
+    return snapshot;
+}
+
+std::vector<size_t> IndexSnapshot::SelectSegmentsToMerge(
+    const MergeOptions& options
+) const
+{
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const int document_count = segments_[i].index->GetDocumentCount();
+        if (document_count - segments_[i].GetLiveDocumentCount()
+                > options.max_removed_share*document_count)
+            return {i};
+    }
+
+    // Segments by tier, the smallest tiers first
+    const size_t merge_factor = std::max<size_t>(options.merge_factor, 2);
+    std::map<int, std::vector<size_t>> tier_to_segments;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const int tier = std::log(segments_[i].GetLiveDocumentCount())
+                       / std::log(merge_factor);
+        tier_to_segments[tier].push_back(i);
+    }
+    for (auto& [tier, segments] : tier_to_segments) {
+        if (segments.size() >= merge_factor) {
+            segments.resize(merge_factor);
+            return segments;
+        }
+    }
+    return {};
+}
+
+std::shared_ptr<const SearchServer> IndexSnapshot::MergeSegments(
+    const std::vector<size_t>& segments
+) const
+{
+    auto merged = std::make_shared<SearchServer>(parser_->stop_words_);
+    for (const size_t i : segments) {
+        const Segment& segment = segments_[i];
+        merged->MergeDocuments(*segment.index, [&segment](int document_id) {
+            return !segment.IsRemoved(document_id);
+        });
+    }
+    return merged;
+}
+
+std::shared_ptr<const IndexSnapshot> IndexSnapshot::ReplaceSegments(
+    const IndexSnapshot& source,
+    const std::vector<size_t>& segments,
+    std::shared_ptr<const SearchServer> merged
+) const
+{
+    auto snapshot = std::make_shared<IndexSnapshot>(parser_);
+    snapshot->document_count_ = document_count_;
+
+    std::vector<const Segment*> merged_segments;
+    for (const size_t i : segments)
+        merged_segments.push_back(&source.segments_[i]);
+
+    // Documents of the merged segment removed after source was taken
+    std::vector<int> removed_ids;
+    std::vector<bool> is_found(merged_segments.size());
+    size_t merged_position = segments_.size();
+    for (const Segment& segment : segments_) {
+        const auto merged_segment = std::find_if(
+            merged_segments.begin(), merged_segments.end(),
+            [&segment](const Segment* merged_segment) {
+                return merged_segment->index == segment.index;
+            }
+        );
+        if (merged_segment == merged_segments.end()) {
+            snapshot->segments_.push_back(segment);
+            continue;
+        }
+
+        is_found[merged_segment - merged_segments.begin()] = true;
+        merged_position = std::min(merged_position, snapshot->segments_.size());
+        if (segment.tombstones)
+            for (const int document_id : segment.tombstones->document_ids)
+                if (!(*merged_segment)->IsRemoved(document_id))
+                    removed_ids.push_back(document_id);
+    }
+    // Segments dropped meanwhile have no live documents left
+    for (size_t i = 0; i < merged_segments.size(); ++i) {
+        if (is_found[i])
+            continue;
+        for (const int document_id : *merged_segments[i]->index)
+            if (!merged_segments[i]->IsRemoved(document_id))
+                removed_ids.push_back(document_id);
+    }
+    std::sort(removed_ids.begin(), removed_ids.end());
+
+    Segment segment = Segment{std::move(merged), nullptr}.RemoveDocuments(removed_ids);
+    if (segment.GetLiveDocumentCount())
+        snapshot->segments_.insert(
+            snapshot->segments_.begin() + std::min(merged_position, snapshot->segments_.size()),
+            std::move(segment)
+        );
+    return snapshot;
+}
+
+size_t IndexSnapshot::FindSegment(int document_id) const {
+    // A removed id may be used again by a later segment
+    for (size_t i = segments_.size(); i-- > 0;)
+        if (segments_[i].HasDocument(document_id))
+            return i;
+    return segments_.size();
+}
+
+std::vector<double> IndexSnapshot::ComputeInverseDocumentFreqs(
+    const SearchServer::Query& query
+) const
+{
+    std::vector<double> inverse_document_freqs;
+    inverse_document_freqs.reserve(query.plus_words.size());
+    for (const std::string_view& word : query.plus_words) {
+        int document_freq = 0;
+        for (const Segment& segment : segments_)
+            document_freq += segment.GetDocumentFreq(word);
+
+        inverse_document_freqs.push_back(
+            document_freq
+                ? log(static_cast<double>(document_count_)/document_freq)
+                : 0
+        );
+    }
+    return inverse_document_freqs;
+}
+
+bool IndexSnapshot::Segment::IsRemoved(int document_id) const {
+    return tombstones
+        && std::binary_search(tombstones->document_ids.begin(),
+                              tombstones->document_ids.end(),
+                              document_id);
+}
+
+int IndexSnapshot::Segment::GetLiveDocumentCount() const {
+    return index->GetDocumentCount()
+         - (tombstones ? tombstones->document_ids.size() : 0);
+}
+
+IndexSnapshot::Segment IndexSnapshot::Segment::RemoveDocuments(
+    const std::vector<int>& document_ids
+) const
+{
+    if (document_ids.empty())
+        return *this;
+
+    auto new_tombstones = tombstones
+        ? std::make_shared<Tombstones>(*tombstones)
+        : std::make_shared<Tombstones>();
+    for (const int document_id : document_ids)
+        for (const int term_id : index->GetDocumentTerms(document_id))
+            ++new_tombstones->term_to_document_count[term_id];
+
+    std::vector<int>& removed_ids = new_tombstones->document_ids;
+    const size_t removed_count = removed_ids.size();
+    removed_ids.insert(removed_ids.end(), document_ids.begin(), document_ids.end());
+    std::inplace_merge(removed_ids.begin(), removed_ids.begin() + removed_count,
+                       removed_ids.end());
+    return {index, std::move(new_tombstones)};
+}
+
+bool IndexSnapshot::Segment::HasDocument(int document_id) const {
+    return index->document_to_ordinal_.count(document_id) && !IsRemoved(document_id);
+}
+
+int IndexSnapshot::Segment::GetDocumentFreq(std::string_view word) const {
+    const int term_id = index->terms_.Find(word);
+    if (term_id == TermDictionary::NOT_FOUND)
+        return 0;
+
+    int document_freq = index->term_to_document_freqs_[term_id].size();
+    if (tombstones) {
+        const auto it = tombstones->term_to_document_count.find(term_id);
+        if (it != tombstones->term_to_document_count.end())
+            document_freq -= it->second;
+    }
+    return document_freq;
+}
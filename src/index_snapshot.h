@@ -0,0 +1,235 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+#include "top_documents.h"
+
+// Immutable version of an index made of segments, each of them a search
+// server of its own which is never changed once published. A change makes a
+// new snapshot sharing all untouched segments with the previous one: added
+// documents form a new segment, and removed documents are tombstoned in
+// their segment. Relevance is computed with corpus-wide statistics, so it is
+// the same as in a single SearchServer of all live documents.
+class IndexSnapshot {
+public:
+    // Tiered merge policy: segments are grouped in tiers by the number of
+    // their live documents, growing by merge_factor times from tier to tier,
+    // and merge_factor segments of a tier are merged into a segment of the
+    // next one. A segment with a larger share of removed documents than
+    // max_removed_share is rewritten to drop them.
+    struct MergeOptions {
+        size_t merge_factor = 4;
+        double max_removed_share = 0.5;
+    };
+
+    explicit IndexSnapshot(std::shared_ptr<const SearchServer> parser);
+
+    inline int GetDocumentCount() const noexcept {
+        return document_count_;
+    }
+
+    inline size_t GetSegmentCount() const noexcept {
+        return segments_.size();
+    }
+
+    bool HasDocument(int document_id) const;
+
+    // Snapshot with a segment of new documents, whose ids must not be used
+    // by live documents of this snapshot
+    std::shared_ptr<const IndexSnapshot> AddSegment(
+        std::shared_ptr<const SearchServer> segment
+    ) const;
+
+    // Snapshot without the documents, unknown ids are ignored
+    std::shared_ptr<const IndexSnapshot> RemoveDocuments(
+        const std::vector<int>& document_ids
+    ) const;
+
+    // Positions of segments to merge by the policy, empty if there are none
+    std::vector<size_t> SelectSegmentsToMerge(const MergeOptions& options) const;
+
+    // Segment of the live documents of the segments at the positions
+    std::shared_ptr<const SearchServer> MergeSegments(
+        const std::vector<size_t>& segments
+    ) const;
+
+    // Snapshot with the merged segment in place of the segments of source,
+    // which this snapshot was made from. Documents removed from them after
+    // source was taken are tombstoned in the merged segment.
+    std::shared_ptr<const IndexSnapshot> ReplaceSegments(
+        const IndexSnapshot& source,
+        const std::vector<size_t>& segments,
+        std::shared_ptr<const SearchServer> merged
+    ) const;
+
+    inline std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::string_view& raw_query,
+        int document_id
+    ) const
+    {
+        return MatchDocument(std::execution::seq, raw_query, document_id);
+    }
+
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        int document_id
+    ) const;
+
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return FindTopDocuments(std::execution::seq, raw_query, status_to_find,
+                                max_document_count);
+    }
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+    template <typename DocumentPredicate>
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return FindTopDocuments(std::execution::seq, raw_query, doc_predicate,
+                                max_document_count);
+    }
+
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+private:
+    // Documents removed from a segment after it was published
+    struct Tombstones {
+        // Sorted
+        std::vector<int> document_ids;
+        // Number of removed documents by term id of the segment
+        std::unordered_map<int, int> term_to_document_count;
+    };
+
+    struct Segment {
+        std::shared_ptr<const SearchServer> index;
+        std::shared_ptr<const Tombstones> tombstones;
+
+        bool IsRemoved(int document_id) const;
+
+        int GetLiveDocumentCount() const;
+
+        // Segment with the removed documents of the sorted ids tombstoned
+        Segment RemoveDocuments(const std::vector<int>& document_ids) const;
+
+        bool HasDocument(int document_id) const;
+
+        int GetDocumentFreq(std::string_view word) const;
+    };
+
+    // Parses queries of all segments, which share its stop words
+    std::shared_ptr<const SearchServer> parser_;
+    std::vector<Segment> segments_;
+    int document_count_ = 0;
+
+    // Segment of a live document or segments_.size()
+    size_t FindSegment(int document_id) const;
+
+    // Inverse document frequencies of the plus words over all segments
+    std::vector<double> ComputeInverseDocumentFreqs(
+        const SearchServer::Query& query
+    ) const;
+};
+
+
+/* ------------------------------- TEMPLATES ------------------------------- */
+
+template <typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> IndexSnapshot::MatchDocument(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    int document_id
+) const
+{
+    const size_t segment = FindSegment(document_id);
+    if (segment == segments_.size())
+        throw std::out_of_range("unknown document id --> " + std::to_string(document_id));
+    return segments_[segment].index->MatchDocument(execution_policy, raw_query,
+                                                   document_id);
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> IndexSnapshot::FindTopDocuments(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    DocumentStatus status_to_find,
+    size_t max_document_count
+) const
+{
+    return FindTopDocuments(
+        execution_policy,
+        raw_query,
+        [status_to_find](__attribute__((unused)) int document_id,
+                        DocumentStatus status,
+                        __attribute__((unused)) int rating)
+        { return status == status_to_find; },
+        max_document_count
+    );
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> IndexSnapshot::FindTopDocuments(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    DocumentPredicate doc_predicate,
+    size_t max_document_count
+) const
+{
+    const SearchServer::Query query = parser_->ParseQuery(execution_policy, raw_query);
+    SearchServer::ThrowInvalidQuery(query);
+    const std::vector<double> inverse_document_freqs = ComputeInverseDocumentFreqs(query);
+
+    return std::transform_reduce(
+        execution_policy,
+        segments_.begin(), segments_.end(),
+        TopDocuments(max_document_count),
+        [](TopDocuments lhs, const TopDocuments& rhs) {
+            lhs.Merge(rhs);
+            return lhs;
+        },
+        [&](const Segment& segment) {
+            const SearchServer& index = *segment.index;
+            return index.FindDocumentsInRange(
+                index.FindQueryPostings(query, inverse_document_freqs),
+                [&segment, &doc_predicate](int document_id, DocumentStatus status, int rating) {
+                    return !segment.IsRemoved(document_id)
+                        && doc_predicate(document_id, status, rating);
+                },
+                0, index.ordinal_to_document_.size(),
+                max_document_count
+            );
+        }
+    ).Build();
+}
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "document.h"
+#include "document_loader.h"
 #include "iostream_helpers.h"
 #include "log_duration.h"
 #include "process_queries.h"
@@ -40,11 +41,20 @@ void AddDocuments(SearchServer& search_server) {
     search_server.AddDocument(14, "nasty rat with curly hair", DocumentStatus::ACTUAL, {3, 2});
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace std;
 
     SearchServer search_server("and with"s);
-    AddDocuments(search_server);
+    if (argc > 1) {
+        // Records are streamed from a file, or from stdin for "-"
+        DocumentLoader loader(search_server);
+        const string path = argv[1];
+        const DocumentLoader::Stats stats = (path == "-"s) ? loader.Load(cin) : loader.Load(path);
+        cerr << stats.document_count << " documents loaded, "
+             << stats.documents_per_second << " documents/s" << endl;
+    } else {
+        AddDocuments(search_server);
+    }
 
     cout << "ACTUAL by default:" << endl;
     for (const Document& document : search_server.FindTopDocuments("curly nasty cat"s))
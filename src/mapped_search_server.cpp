@@ -0,0 +1,221 @@
+#include "mapped_search_server.h"
+
+MappedSearchServer MappedSearchServer::Open(const std::string& path, bool skip_checksum) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        const int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+
+    const size_t size = file_stat.st_size;
+    if (size < sizeof(IndexFileHeader)) {
+        close(fd);
+        throw std::invalid_argument("truncated index file --> " + path);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (data == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), path);
+
+    MappedSearchServer mapped_server(
+        std::shared_ptr<const char>(
+            static_cast<const char*>(data),
+            [size](const char* data) { munmap(const_cast<char*>(data), size); }
+        ),
+        size,
+        path
+    );
+    if (!skip_checksum && !(mapped_server.VerifyChecksum() && mapped_server.HasValidReferences()))
+        throw std::invalid_argument("corrupted index file --> " + path);
+    return mapped_server;
+}
+
+MappedSearchServer::MappedSearchServer(std::shared_ptr<const char> data,
+                                       size_t size,
+                                       const std::string& path)
+    : data_(std::move(data))
+    , size_(size)
+    , header_(reinterpret_cast<const IndexFileHeader*>(data_.get()))
+{
+    if (!std::equal(std::begin(INDEX_FILE_MAGIC), std::end(INDEX_FILE_MAGIC), header_->magic))
+        throw std::invalid_argument("not an index file --> " + path);
+    if (header_->version != INDEX_FILE_VERSION
+        || header_->header_size != sizeof(IndexFileHeader))
+        throw std::invalid_argument(
+            "unsupported index file version --> " + std::to_string(header_->version)
+        );
+
+    // Counts are bounded by the file size before sections are sized by them,
+    // so the layout cannot overflow
+    for (const uint64_t count : {header_->document_count, header_->term_count,
+                                 header_->posting_count, header_->stop_words_size,
+                                 header_->words_size})
+        if (count > size_)
+            throw std::invalid_argument("truncated index file --> " + path);
+    if (header_->document_count > INT32_MAX || header_->term_count > INT32_MAX)
+        throw std::invalid_argument("corrupted index file --> " + path);
+
+    const IndexFileLayout layout = ComputeIndexFileLayout(*header_);
+    if (layout.file_size != size_)
+        throw std::invalid_argument("truncated index file --> " + path);
+    ThrowInvalidLayout(layout, path);
+
+    const char* data_begin = data_.get();
+    term_word_offsets_ = reinterpret_cast<const uint64_t*>(data_begin + layout.term_word_offsets);
+    words_ = data_begin + layout.words;
+    term_posting_offsets_ = reinterpret_cast<const uint64_t*>(data_begin + layout.term_posting_offsets);
+    posting_ordinals_ = reinterpret_cast<const int32_t*>(data_begin + layout.posting_ordinals);
+    posting_term_freqs_ = reinterpret_cast<const double*>(data_begin + layout.posting_term_freqs);
+    document_ids_ = reinterpret_cast<const int32_t*>(data_begin + layout.document_ids);
+    document_statuses_ = reinterpret_cast<const int32_t*>(data_begin + layout.document_statuses);
+    document_ratings_ = reinterpret_cast<const int32_t*>(data_begin + layout.document_ratings);
+    document_term_offsets_ = reinterpret_cast<const uint64_t*>(data_begin + layout.document_term_offsets);
+    document_terms_ = reinterpret_cast<const int32_t*>(data_begin + layout.document_terms);
+
+    // Offsets are followed by every lookup, so they are checked here, while
+    // the postings they delimit are checked along with the checksum
+    ThrowInvalidOffsets(term_word_offsets_, header_->term_count, header_->words_size, path);
+    ThrowInvalidOffsets(term_posting_offsets_, header_->term_count, header_->posting_count, path);
+    ThrowInvalidOffsets(document_term_offsets_, header_->document_count, header_->posting_count, path);
+
+    parser_ = std::make_shared<const SearchServer>(
+        std::string_view(data_begin + layout.stop_words, header_->stop_words_size)
+    );
+}
+
+void MappedSearchServer::ThrowInvalidLayout(const IndexFileLayout& layout,
+                                            const std::string& path) const
+{
+    const auto& header = *header_;
+    // Sections in the order of the file with the sizes of their contents
+    const std::pair<size_t, size_t> sections[] = {
+        {layout.stop_words, header.stop_words_size},
+        {layout.term_word_offsets, (header.term_count + 1)*sizeof(uint64_t)},
+        {layout.words, header.words_size},
+        {layout.term_posting_offsets, (header.term_count + 1)*sizeof(uint64_t)},
+        {layout.posting_ordinals, header.posting_count*sizeof(int32_t)},
+        {layout.posting_term_freqs, header.posting_count*sizeof(double)},
+        {layout.document_ids, header.document_count*sizeof(int32_t)},
+        {layout.document_statuses, header.document_count*sizeof(int32_t)},
+        {layout.document_ratings, header.document_count*sizeof(int32_t)},
+        {layout.document_term_offsets, (header.document_count + 1)*sizeof(uint64_t)},
+        {layout.document_terms, header.posting_count*sizeof(int32_t)},
+    };
+
+    size_t end = sizeof(IndexFileHeader);
+    for (const auto& [offset, size] : sections) {
+        if (offset % INDEX_FILE_ALIGNMENT != 0 || offset < end
+            || offset > size_ || size > size_ - offset)
+            throw std::invalid_argument("corrupted index file layout --> " + path);
+        end = offset + size;
+    }
+}
+
+void MappedSearchServer::ThrowInvalidOffsets(const uint64_t* offsets,
+                                             size_t count,
+                                             size_t section_size,
+                                             const std::string& path)
+{
+    if (offsets[0] != 0)
+        throw std::invalid_argument("corrupted index file offsets --> " + path);
+    for (size_t i = 0; i < count; ++i)
+        if (offsets[i + 1] < offsets[i])
+            throw std::invalid_argument("corrupted index file offsets --> " + path);
+    if (offsets[count] > section_size)
+        throw std::invalid_argument("corrupted index file offsets --> " + path);
+}
+
+bool MappedSearchServer::VerifyChecksum() const {
+    const size_t header_size = AlignIndexFileSize(sizeof(IndexFileHeader));
+    return ComputeIndexFileChecksum(data_.get() + header_size, size_ - header_size)
+        == header_->checksum;
+}
+
+bool MappedSearchServer::HasValidReferences() const {
+    const auto is_ordinal = [this](int32_t ordinal) {
+        return ordinal >= 0 && static_cast<uint64_t>(ordinal) < header_->document_count;
+    };
+    const auto is_term_id = [this](int32_t term_id) {
+        return term_id >= 0 && static_cast<uint64_t>(term_id) < header_->term_count;
+    };
+    return std::all_of(posting_ordinals_, posting_ordinals_ + header_->posting_count, is_ordinal)
+        && std::all_of(document_terms_, document_terms_ + header_->posting_count, is_term_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> MappedSearchServer::MatchDocument(
+    const std::string_view& raw_query,
+    int document_id
+) const
+{
+    const int ordinal = FindDocument(document_id);
+    if (ordinal == NOT_FOUND)
+        throw std::out_of_range("unknown document id --> " + std::to_string(document_id));
+    const DocumentStatus status = static_cast<DocumentStatus>(document_statuses_[ordinal]);
+
+    const SearchServer::Query query = parser_->ParseQuery(raw_query);
+    SearchServer::ThrowInvalidQuery(query);
+
+    std::vector<std::string_view> matched_words;
+    for (const std::string_view& word : query.minus_words)
+        if (IsDocumentContainWord(ordinal, word))
+            return {matched_words, status};
+
+    for (const std::string_view& word : query.plus_words)
+        if (IsDocumentContainWord(ordinal, word))
+            matched_words.push_back(word);
+    return {matched_words, status};
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(
+    const std::string_view& raw_query,
+    DocumentStatus status_to_find,
+    size_t max_document_count
+) const
+{
+    return FindTopDocuments(
+        raw_query,
+        [status_to_find](__attribute__((unused)) int document_id,
+                        DocumentStatus status,
+                        __attribute__((unused)) int rating)
+        { return status == status_to_find; },
+        max_document_count
+    );
+}
+
+int MappedSearchServer::FindTerm(std::string_view word) const {
+    int first = 0;
+    int last = header_->term_count;
+    while (first < last) {
+        const int middle = first + (last - first)/2;
+        if (GetWord(middle) < word)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first < static_cast<int>(header_->term_count) && GetWord(first) == word
+        ? first
+        : NOT_FOUND;
+}
+
+int MappedSearchServer::FindDocument(int document_id) const {
+    const int32_t* document_ids_end = document_ids_ + header_->document_count;
+    const int32_t* it = std::lower_bound(document_ids_, document_ids_end, document_id);
+    return it != document_ids_end && *it == document_id
+        ? it - document_ids_
+        : NOT_FOUND;
+}
+
+bool MappedSearchServer::IsDocumentContainWord(int ordinal, std::string_view word) const {
+    const int term_id = FindTerm(word);
+    return term_id != NOT_FOUND
+        && std::binary_search(document_terms_ + document_term_offsets_[ordinal],
+                              document_terms_ + document_term_offsets_[ordinal + 1],
+                              term_id);
+}
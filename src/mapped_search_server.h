@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "document.h"
+#include "index_file.h"
+#include "relevance_accumulator.h"
+#include "search_server.h"
+#include "top_documents.h"
+
+// Read-only index served straight from a memory-mapped file written by
+// SearchServer::Save. Opening a trusted file without its checksum reads
+// only the header, the stop words and the offsets, so startup takes time
+// proportional to the pages touched rather than to the postings, and
+// queries fault in the pages of their postings.
+// Copies share the mapping.
+class MappedSearchServer {
+public:
+    // Checks the header, the layout of the sections and the offsets of words
+    // and postings. Then reads the whole file to check its checksum and the
+    // ordinals and term ids of postings, unless skip_checksum is set for
+    // a trusted file, whose opening then touches the offsets only.
+    static MappedSearchServer Open(const std::string& path, bool skip_checksum = false);
+
+    inline int GetDocumentCount() const noexcept {
+        return header_->document_count;
+    }
+
+    // Reads the whole file to compare it with the checksum of the header
+    bool VerifyChecksum() const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::string_view& raw_query,
+        int document_id
+    ) const;
+
+    std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+private:
+    static const int NOT_FOUND = -1;
+
+    std::shared_ptr<const char> data_;
+    size_t size_ = 0;
+    std::shared_ptr<const SearchServer> parser_;
+
+    const IndexFileHeader* header_ = nullptr;
+    const uint64_t* term_word_offsets_ = nullptr;
+    const char* words_ = nullptr;
+    const uint64_t* term_posting_offsets_ = nullptr;
+    const int32_t* posting_ordinals_ = nullptr;
+    const double* posting_term_freqs_ = nullptr;
+    const int32_t* document_ids_ = nullptr;
+    const int32_t* document_statuses_ = nullptr;
+    const int32_t* document_ratings_ = nullptr;
+    const uint64_t* document_term_offsets_ = nullptr;
+    const int32_t* document_terms_ = nullptr;
+
+    MappedSearchServer(std::shared_ptr<const char> data, size_t size, const std::string& path);
+
+    // Sections must be aligned, ordered and contained in the file
+    void ThrowInvalidLayout(const IndexFileLayout& layout, const std::string& path) const;
+
+    // count + 1 offsets must start at zero, never decrease and end within
+    // a section of section_size entries
+    static void ThrowInvalidOffsets(const uint64_t* offsets, size_t count,
+                                    size_t section_size, const std::string& path);
+
+    // Ordinals and term ids of postings are in range
+    bool HasValidReferences() const;
+
+    inline std::string_view GetWord(int term_id) const {
+        return {words_ + term_word_offsets_[term_id],
+                term_word_offsets_[term_id + 1] - term_word_offsets_[term_id]};
+    }
+
+    // Binary search of the word among the words of the file, which are
+    // sorted, so the position found is its term id. NOT_FOUND if absent.
+    int FindTerm(std::string_view word) const;
+
+    // Binary search of the sorted document ids. NOT_FOUND if absent.
+    int FindDocument(int document_id) const;
+
+    bool IsDocumentContainWord(int ordinal, std::string_view word) const;
+
+    template <typename Function>
+    void ForEachPosting(int term_id, Function function) const {
+        for (uint64_t i = term_posting_offsets_[term_id]; i < term_posting_offsets_[term_id + 1]; ++i)
+            function(posting_ordinals_[i], posting_term_freqs_[i]);
+    }
+};
+
+
+/* ------------------------------- TEMPLATES ------------------------------- */
+
+template <typename DocumentPredicate>
+std::vector<Document> MappedSearchServer::FindTopDocuments(
+    const std::string_view& raw_query,
+    DocumentPredicate doc_predicate,
+    size_t max_document_count
+) const
+{
+    const SearchServer::Query query = parser_->ParseQuery(raw_query);
+    SearchServer::ThrowInvalidQuery(query);
+
+    RelevanceAccumulator& accumulator = RelevanceAccumulator::Get(GetDocumentCount());
+    for (const std::string_view& word : query.minus_words) {
+        const int term_id = FindTerm(word);
+        if (term_id != NOT_FOUND)
+            ForEachPosting(term_id, [&accumulator](int ordinal, double) {
+                accumulator.Exclude(ordinal);
+            });
+    }
+
+    // Statuses and ratings are read from the mapping only for documents
+    // the accumulator has not seen yet, so a document costs one predicate
+    // call however many plus words it has
+    for (const std::string_view& word : query.plus_words) {
+        const int term_id = FindTerm(word);
+        if (term_id == NOT_FOUND)
+            continue;
+
+        const double inverse_document_freq = std::log(
+            static_cast<double>(GetDocumentCount())
+            /(term_posting_offsets_[term_id + 1] - term_posting_offsets_[term_id])
+        );
+        ForEachPosting(term_id, [&](int ordinal, double term_freq) {
+            if (accumulator.IsUntouched(ordinal)) {
+                if (doc_predicate(document_ids_[ordinal],
+                                  static_cast<DocumentStatus>(document_statuses_[ordinal]),
+                                  document_ratings_[ordinal]))
+                    accumulator.Match(ordinal);
+                else
+                    accumulator.Exclude(ordinal);
+            }
+            if (accumulator.IsMatched(ordinal))
+                accumulator.Add(ordinal, term_freq*inverse_document_freq);
+        });
+    }
+
+    TopDocuments top_documents(max_document_count);
+    for (const uint32_t ordinal : accumulator.GetMatched())
+        top_documents.Add({
+            document_ids_[ordinal],
+            accumulator.GetRelevance(ordinal),
+            document_ratings_[ordinal]
+        });
+    return std::move(top_documents).Build();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <memory_resource>
+
+// Pool of memory for the std::pmr containers of an object: nodes and small
+// arrays are carved out of large blocks, and freed ones are reused by
+// later allocations. The blocks are released at once with the pool.
+//
+// Containers keep a pointer to the pool in their allocators, so copies of
+// the object get pools of their own, moved objects share the pool with the
+// containers moved out of them, and an assigned object keeps its pool, as
+// std::pmr containers keep their allocators on assignment. A pool is not
+// thread-safe, as its containers are not.
+class MemoryPool {
+public:
+    MemoryPool()
+        : resource_(std::make_shared<std::pmr::unsynchronized_pool_resource>())
+    {
+    }
+
+    MemoryPool(const MemoryPool&)
+        : MemoryPool()
+    {
+    }
+
+    MemoryPool(MemoryPool&& other) noexcept
+        : resource_(other.resource_)
+    {
+    }
+
+    MemoryPool& operator=(const MemoryPool&) noexcept {
+        return *this;
+    }
+
+    MemoryPool& operator=(MemoryPool&&) noexcept {
+        return *this;
+    }
+
+    inline std::pmr::memory_resource* get() const noexcept {
+        return resource_.get();
+    }
+
+private:
+    std::shared_ptr<std::pmr::unsynchronized_pool_resource> resource_;
+};
@@ -0,0 +1,364 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// Postings of a single word ordered by document ordinal, compressed in
+// blocks. Postings are appended to a short tail of plain arrays, which is
+// packed into a block once it holds BLOCK_SIZE postings. A block stores:
+//
+//   - differences between consecutive ordinals, bit-packed at the width
+//     of the largest one;
+//   - a byte per posting indexing its term frequency in the table of
+//     distinct term frequencies of the block, so they stay exact;
+//   - the table itself.
+//
+// Headers of the blocks hold their first and last ordinals, so a range of
+// ordinals is found by a binary search over the headers, and blocks before
+// it are skipped without decoding. A removed posting is tombstoned by
+// a negative term frequency in the tail or REMOVED_INDEX in a block and
+// dropped by packing the list again once tombstones make up half of it.
+// Adding an ordinal below the last one packs the list again too.
+class PostingList {
+public:
+    PostingList() = default;
+
+    inline size_t size() const noexcept {
+        return GetPostingCount() - removed_count_;
+    }
+
+    inline bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    void Add(int ordinal, double term_freq) {
+        if (GetPostingCount() == 0 || GetLastOrdinal() < ordinal) {
+            Append(ordinal, term_freq);
+            return;
+        }
+
+        std::vector<int> ordinals;
+        std::vector<double> term_freqs;
+        Unpack(ordinals, term_freqs);
+        const size_t pos = std::lower_bound(ordinals.begin(), ordinals.end(), ordinal)
+            - ordinals.begin();
+        if (pos < ordinals.size() && ordinals[pos] == ordinal) {
+            term_freqs[pos] = term_freq;
+        } else {
+            ordinals.insert(ordinals.begin() + pos, ordinal);
+            term_freqs.insert(term_freqs.begin() + pos, term_freq);
+        }
+        Pack(ordinals, term_freqs);
+    }
+
+    bool Erase(int ordinal) {
+        const int* first = &ordinal;
+        return Erase(first, first + 1) != 0;
+    }
+
+    // Erases postings of the sorted ordinals in [first, last)
+    // with a single compaction check, returns the number of erased postings
+    template <typename Iterator>
+    size_t Erase(Iterator first, Iterator last) {
+        size_t erased_count = 0;
+        BlockCursor cursor;
+        for (; first != last; ++first) {
+            const Position position = Find(*first, cursor);
+            if (position.is_found && !IsRemoved(position)) {
+                MarkRemoved(position);
+                ++erased_count;
+            }
+        }
+
+        removed_count_ += erased_count;
+        if (removed_count_*2 > GetPostingCount())
+            Compact();
+        return erased_count;
+    }
+
+    inline bool Contains(int ordinal) const {
+        BlockCursor cursor;
+        const Position position = Find(ordinal, cursor);
+        return position.is_found && !IsRemoved(position);
+    }
+
+    // Replaces every ordinal by new_ordinals[ordinal], which must keep the order
+    void Renumber(const std::vector<int>& new_ordinals) {
+        std::vector<int> ordinals;
+        std::vector<double> term_freqs;
+        Unpack(ordinals, term_freqs);
+        for (int& ordinal : ordinals)
+            ordinal = new_ordinals[ordinal];
+        Pack(ordinals, term_freqs);
+    }
+
+    template <typename Function>
+    void ForEach(Function function) const {
+        ForEach(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), function);
+    }
+
+    // Visits live postings with ordinals in [first_ordinal, last_ordinal)
+    template <typename Function>
+    void ForEach(int first_ordinal, int last_ordinal, Function function) const {
+        for (size_t i = FindBlock(first_ordinal);
+             i < blocks_.size() && blocks_[i].first_ordinal < last_ordinal;
+             ++i)
+            ForEachInBlock(blocks_[i], first_ordinal, last_ordinal, function);
+
+        for (size_t i = std::lower_bound(tail_ordinals_.begin(), tail_ordinals_.end(), first_ordinal)
+                 - tail_ordinals_.begin();
+             i < tail_ordinals_.size() && tail_ordinals_[i] < last_ordinal;
+             ++i)
+            if (tail_term_freqs_[i] >= 0.0)
+                function(tail_ordinals_[i], tail_term_freqs_[i]);
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 128;
+    // Blocks have at most BLOCK_SIZE distinct term frequencies,
+    // so the index is never used for one of them
+    static constexpr uint8_t REMOVED_INDEX = 0xFF;
+    static constexpr double REMOVED = -1.0;
+    // Deltas are read by 8-byte loads, which may run past the last block
+    static constexpr size_t PADDING = sizeof(uint64_t);
+
+    struct Block {
+        int first_ordinal;
+        int last_ordinal;
+        uint32_t data_offset;
+        uint8_t size;
+        uint8_t delta_bits;
+    };
+
+    // Posting found by Find(), in the tail if block is the number of blocks
+    struct Position {
+        bool is_found;
+        size_t block;
+        size_t pos;
+    };
+
+    // Leading ordinals of the block decoded last by Find(), so lookups of
+    // ascending ordinals decode every block once
+    struct BlockCursor {
+        size_t block = std::numeric_limits<size_t>::max();
+        size_t size = 0;
+        int ordinals[BLOCK_SIZE];
+    };
+
+    std::vector<Block> blocks_;
+    // Bit-packed deltas, term frequency indices and term frequency tables
+    // of the blocks, then PADDING zero bytes
+    std::vector<uint8_t> data_;
+    size_t block_posting_count_ = 0;
+    std::vector<int> tail_ordinals_;
+    std::vector<double> tail_term_freqs_;
+    size_t removed_count_ = 0;
+
+    inline size_t GetPostingCount() const noexcept {
+        return block_posting_count_ + tail_ordinals_.size();
+    }
+
+    inline int GetLastOrdinal() const {
+        return tail_ordinals_.empty() ? blocks_.back().last_ordinal : tail_ordinals_.back();
+    }
+
+    static inline size_t GetDeltaSize(const Block& block) {
+        return ((block.size - 1)*block.delta_bits + 7)/8;
+    }
+
+    inline const uint8_t* GetTermFreqIndices(const Block& block) const {
+        return data_.data() + block.data_offset + GetDeltaSize(block);
+    }
+
+    inline const uint8_t* GetTermFreqs(const Block& block) const {
+        return GetTermFreqIndices(block) + block.size;
+    }
+
+    static inline double ReadTermFreq(const uint8_t* term_freqs, uint8_t index) {
+        double term_freq;
+        std::memcpy(&term_freq, term_freqs + index*sizeof(double), sizeof(double));
+        return term_freq;
+    }
+
+    // Delta starting at the given bit, stored little-endian
+    static inline int ReadDelta(const uint8_t* deltas, size_t bit, uint64_t mask) {
+        uint64_t word;
+        std::memcpy(&word, deltas + bit/8, sizeof(word));
+        return (word >> bit%8) & mask;
+    }
+
+    // First block whose last ordinal isn't less than ordinal
+    inline size_t FindBlock(int ordinal) const {
+        return std::partition_point(blocks_.begin(), blocks_.end(), [ordinal](const Block& block) {
+                   return block.last_ordinal < ordinal;
+               })
+             - blocks_.begin();
+    }
+
+    template <typename Function>
+    void ForEachInBlock(const Block& block,
+                        int first_ordinal,
+                        int last_ordinal,
+                        Function& function) const {
+        const uint8_t* deltas = data_.data() + block.data_offset;
+        const uint8_t* indices = GetTermFreqIndices(block);
+        const uint8_t* term_freqs = GetTermFreqs(block);
+        const uint64_t mask = (uint64_t{1} << block.delta_bits) - 1;
+
+        int ordinal = block.first_ordinal;
+        size_t bit = 0;
+        for (size_t i = 0; ordinal < last_ordinal; ) {
+            if (ordinal >= first_ordinal && indices[i] != REMOVED_INDEX)
+                function(ordinal, ReadTermFreq(term_freqs, indices[i]));
+            if (++i == block.size)
+                break;
+            ordinal += ReadDelta(deltas, bit, mask);
+            bit += block.delta_bits;
+        }
+    }
+
+    // Posting of the ordinal, live or removed
+    Position Find(int ordinal, BlockCursor& cursor) const {
+        if (blocks_.empty() || blocks_.back().last_ordinal < ordinal) {
+            const size_t pos = std::lower_bound(tail_ordinals_.begin(), tail_ordinals_.end(), ordinal)
+                - tail_ordinals_.begin();
+            return {pos < tail_ordinals_.size() && tail_ordinals_[pos] == ordinal, blocks_.size(), pos};
+        }
+
+        const size_t block = FindBlock(ordinal);
+        if (block == blocks_.size() || blocks_[block].first_ordinal > ordinal)
+            return {false, block, 0};
+
+        // Ordinals are decoded up to the one looked for only
+        const Block& found_block = blocks_[block];
+        if (cursor.block != block) {
+            cursor.block = block;
+            cursor.ordinals[0] = found_block.first_ordinal;
+            cursor.size = 1;
+        }
+        const uint8_t* deltas = data_.data() + found_block.data_offset;
+        const uint64_t mask = (uint64_t{1} << found_block.delta_bits) - 1;
+        size_t size = cursor.size;
+        int last_ordinal = cursor.ordinals[size - 1];
+        for (size_t bit = (size - 1)*found_block.delta_bits;
+             size < found_block.size && last_ordinal < ordinal;
+             bit += found_block.delta_bits) {
+            last_ordinal += ReadDelta(deltas, bit, mask);
+            cursor.ordinals[size++] = last_ordinal;
+        }
+        cursor.size = size;
+
+        const int* ordinals = cursor.ordinals;
+        const size_t pos = std::lower_bound(ordinals, ordinals + cursor.size, ordinal) - ordinals;
+        return {ordinals[pos] == ordinal, block, pos};
+    }
+
+    inline bool IsRemoved(const Position& position) const {
+        return position.block == blocks_.size()
+            ? tail_term_freqs_[position.pos] < 0.0
+            : GetTermFreqIndices(blocks_[position.block])[position.pos] == REMOVED_INDEX;
+    }
+
+    void MarkRemoved(const Position& position) {
+        if (position.block == blocks_.size()) {
+            tail_term_freqs_[position.pos] = REMOVED;
+        } else {
+            const Block& block = blocks_[position.block];
+            data_[block.data_offset + GetDeltaSize(block) + position.pos] = REMOVED_INDEX;
+        }
+    }
+
+    void Append(int ordinal, double term_freq) {
+        tail_ordinals_.push_back(ordinal);
+        tail_term_freqs_.push_back(term_freq);
+        if (tail_ordinals_.size() == BLOCK_SIZE)
+            PackTail();
+    }
+
+    void PackTail() {
+        Block block{tail_ordinals_.front(), tail_ordinals_.back(), 0,
+                    static_cast<uint8_t>(tail_ordinals_.size()), 1};
+        for (size_t i = 1; i < tail_ordinals_.size(); ++i)
+            while ((tail_ordinals_[i] - tail_ordinals_[i - 1]) >> block.delta_bits)
+                ++block.delta_bits;
+
+        if (!data_.empty())
+            data_.resize(data_.size() - PADDING);
+        block.data_offset = data_.size();
+
+        uint64_t buffer = 0;
+        size_t buffer_bits = 0;
+        for (size_t i = 1; i < tail_ordinals_.size(); ++i) {
+            buffer |= static_cast<uint64_t>(tail_ordinals_[i] - tail_ordinals_[i - 1]) << buffer_bits;
+            for (buffer_bits += block.delta_bits; buffer_bits >= 8; buffer_bits -= 8) {
+                data_.push_back(buffer);
+                buffer >>= 8;
+            }
+        }
+        if (buffer_bits)
+            data_.push_back(buffer);
+
+        // Blocks have few distinct term frequencies, which are looked up
+        // in the table faster than they are sorted
+        double term_freqs[BLOCK_SIZE];
+        size_t term_freq_count = 0;
+        for (const double term_freq : tail_term_freqs_) {
+            if (term_freq < 0.0) {
+                data_.push_back(REMOVED_INDEX);
+                continue;
+            }
+            const size_t index = std::find(term_freqs, term_freqs + term_freq_count, term_freq)
+                - term_freqs;
+            if (index == term_freq_count)
+                term_freqs[term_freq_count++] = term_freq;
+            data_.push_back(index);
+        }
+
+        const size_t term_freqs_offset = data_.size();
+        const size_t term_freqs_size = term_freq_count*sizeof(double);
+        data_.resize(data_.size() + term_freqs_size + PADDING);
+        std::memcpy(data_.data() + term_freqs_offset, term_freqs, term_freqs_size);
+
+        blocks_.push_back(block);
+        block_posting_count_ += tail_ordinals_.size();
+        tail_ordinals_.clear();
+        tail_term_freqs_.clear();
+    }
+
+    // Live postings in order
+    void Unpack(std::vector<int>& ordinals, std::vector<double>& term_freqs) const {
+        ordinals.reserve(size());
+        term_freqs.reserve(size());
+        ForEach([&ordinals, &term_freqs](int ordinal, double term_freq) {
+            ordinals.push_back(ordinal);
+            term_freqs.push_back(term_freq);
+        });
+    }
+
+    // Replaces the postings by the given ones without tombstones
+    void Pack(const std::vector<int>& ordinals, const std::vector<double>& term_freqs) {
+        blocks_.clear();
+        data_.clear();
+        block_posting_count_ = 0;
+        tail_ordinals_.clear();
+        tail_term_freqs_.clear();
+        removed_count_ = 0;
+
+        for (size_t i = 0; i < ordinals.size(); ++i)
+            Append(ordinals[i], term_freqs[i]);
+
+        blocks_.shrink_to_fit();
+        data_.shrink_to_fit();
+        tail_ordinals_.shrink_to_fit();
+        tail_term_freqs_.shrink_to_fit();
+    }
+
+    void Compact() {
+        std::vector<int> ordinals;
+        std::vector<double> term_freqs;
+        Unpack(ordinals, term_freqs);
+        Pack(ordinals, term_freqs);
+    }
+};
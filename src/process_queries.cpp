@@ -18,16 +18,10 @@ std::vector<std::vector<Document>> ProcessQueries(
     return found_documents_by_queries;
 }
 
-std::vector<Document> ProcessQueriesJoined(
-    const SearchServer& search_server,
-    const std::vector<std::string>& queries
+static std::vector<Document> JoinDocuments(
+    const std::vector<std::vector<Document>>& found_documents_by_queries
 )
 {
-    std::vector<std::vector<Document>> found_documents_by_queries = ProcessQueries(
-        search_server,
-        queries
-    );
-
     std::vector<Document> joined_documents_by_queries;
     for (const std::vector<Document>& found_documents : found_documents_by_queries)
         joined_documents_by_queries.insert(
@@ -37,4 +31,38 @@ std::vector<Document> ProcessQueriesJoined(
         );
 
     return joined_documents_by_queries;
+}
+
+std::vector<Document> ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries
+)
+{
+    return JoinDocuments(ProcessQueries(search_server, queries));
+}
+
+std::vector<std::vector<Document>> ProcessQueries(
+    QueryResultCache& cache,
+    const std::vector<std::string>& queries
+)
+{
+    std::vector<std::vector<Document>> found_documents_by_queries(queries.size());
+    std::transform(
+        std::execution::par,
+        queries.begin(),
+        queries.end(),
+        found_documents_by_queries.begin(),
+        [&cache](const std::string& query) {
+            return cache.FindTopDocuments(query);
+        }
+    );
+    return found_documents_by_queries;
+}
+
+std::vector<Document> ProcessQueriesJoined(
+    QueryResultCache& cache,
+    const std::vector<std::string>& queries
+)
+{
+    return JoinDocuments(ProcessQueries(cache, queries));
 }
\ No newline at end of file
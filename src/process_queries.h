@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "query_result_cache.h"
 #include "search_server.h"
 
 std::vector<std::vector<Document>> ProcessQueries(
@@ -14,4 +15,15 @@ std::vector<std::vector<Document>> ProcessQueries(
 std::vector<Document> ProcessQueriesJoined(
     const SearchServer& search_server,
     const std::vector<std::string>& queries
+);
+
+// Overloads answering repeated queries from the cache
+std::vector<std::vector<Document>> ProcessQueries(
+    QueryResultCache& cache,
+    const std::vector<std::string>& queries
+);
+
+std::vector<Document> ProcessQueriesJoined(
+    QueryResultCache& cache,
+    const std::vector<std::string>& queries
 );
\ No newline at end of file
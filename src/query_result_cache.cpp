@@ -0,0 +1,127 @@
+#include "query_result_cache.h"
+
+QueryResultCache::QueryResultCache(const SearchServer& search_server,
+                                   size_t capacity,
+                                   size_t shard_count)
+    : search_server_(search_server)
+    , shard_capacity_(shard_count ? (capacity + shard_count - 1)/shard_count : 0)
+{
+    if (capacity == 0 || shard_count == 0)
+        throw std::invalid_argument("zero capacity or shard count of a query cache");
+
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+        shards_.push_back(std::make_unique<Shard>());
+}
+
+std::vector<Document> QueryResultCache::FindTopDocuments(
+    const std::string_view& raw_query,
+    DocumentStatus status_to_find,
+    size_t max_document_count
+)
+{
+    // Keeps its capacity between calls like the query of MatchDocument
+    thread_local SearchServer::Query query;
+    search_server_.ParseQuery(std::execution::seq, raw_query, query);
+    SearchServer::ThrowInvalidQuery(query);
+
+    std::string key = MakeKey(query, status_to_find, max_document_count);
+    std::vector<Document> documents;
+    if (Find(key, documents))
+        return documents;
+
+    // Concurrent misses of a key compute it twice rather than wait
+    // for each other, the later result replaces the earlier one
+    documents = search_server_.FindAllDocuments(
+        std::execution::seq,
+        query,
+        [status_to_find](__attribute__((unused)) int document_id,
+                        DocumentStatus status,
+                        __attribute__((unused)) int rating)
+        { return status == status_to_find; },
+        max_document_count
+    );
+    Insert(std::move(key), documents);
+    return documents;
+}
+
+QueryResultCache::Stats QueryResultCache::GetStats() const {
+    Stats stats;
+    for (const std::unique_ptr<Shard>& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.hit_count += shard->stats.hit_count;
+        stats.miss_count += shard->stats.miss_count;
+        stats.eviction_count += shard->stats.eviction_count;
+        stats.invalidation_count += shard->stats.invalidation_count;
+        stats.size += shard->entries.size();
+    }
+    return stats;
+}
+
+std::string QueryResultCache::MakeKey(const SearchServer::Query& query,
+                                      DocumentStatus status_to_find,
+                                      size_t max_document_count) {
+    std::string key;
+    for (const std::string_view& word : query.plus_words) {
+        key += word;
+        key.push_back(' ');
+    }
+    key.push_back('\n');
+    for (const std::string_view& word : query.minus_words) {
+        key += word;
+        key.push_back(' ');
+    }
+    key.push_back('\n');
+    key += std::to_string(static_cast<int>(status_to_find));
+    key.push_back(' ');
+    key += std::to_string(max_document_count);
+    return key;
+}
+
+void QueryResultCache::Invalidate(Shard& shard) const {
+    if (shard.generation == search_server_.generation_)
+        return;
+
+    shard.stats.invalidation_count += shard.entries.size();
+    shard.key_to_entry.clear();
+    shard.entries.clear();
+    shard.generation = search_server_.generation_;
+}
+
+bool QueryResultCache::Find(const std::string& key, std::vector<Document>& documents) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Invalidate(shard);
+
+    const auto it = shard.key_to_entry.find(key);
+    if (it == shard.key_to_entry.end()) {
+        ++shard.stats.miss_count;
+        return false;
+    }
+
+    ++shard.stats.hit_count;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    documents = it->second->documents;
+    return true;
+}
+
+void QueryResultCache::Insert(std::string key, const std::vector<Document>& documents) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Invalidate(shard);
+
+    const auto it = shard.key_to_entry.find(key);
+    if (it != shard.key_to_entry.end()) {
+        it->second->documents = documents;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+
+    if (shard.entries.size() == shard_capacity_) {
+        shard.key_to_entry.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+        ++shard.stats.eviction_count;
+    }
+    shard.entries.push_front({std::move(key), documents});
+    shard.key_to_entry.emplace(shard.entries.front().key, shard.entries.begin());
+}
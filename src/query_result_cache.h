@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+
+// Results of FindTopDocuments by status cached in front of a SearchServer.
+// Queries are keyed by their parsed form, so queries differing only in
+// the order or repetition of words or in stop words share an entry.
+//
+// The cache is split into shards by the hash of the key, each of them an
+// LRU list guarded by a mutex of its own, so concurrent queries rarely wait
+// for each other. Every change of the index bumps its generation, and
+// a shard drops its entries once it meets a newer generation, so a cached
+// result is never older than the index. Like the server, the cache may be
+// queried concurrently, but not while the server is changed.
+class QueryResultCache {
+public:
+    struct Stats {
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+        // Entries dropped to make room for new ones
+        uint64_t eviction_count = 0;
+        // Entries dropped as results of an older index
+        uint64_t invalidation_count = 0;
+        size_t size = 0;
+    };
+
+    // Keeps at most capacity results split evenly among shards
+    QueryResultCache(const SearchServer& search_server,
+                     size_t capacity,
+                     size_t shard_count = 16);
+
+    std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    );
+
+    inline const SearchServer& GetSearchServer() const noexcept {
+        return search_server_;
+    }
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<Document> documents;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        uint64_t generation = 0;
+        // Most recently used entries first
+        std::list<Entry> entries;
+        // Keys are views of the keys of the entries
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> key_to_entry;
+        Stats stats;
+    };
+
+    const SearchServer& search_server_;
+    const size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Canonical form of a parsed query: sorted plus words and sorted minus
+    // words, which contain no control characters, then the parameters
+    static std::string MakeKey(const SearchServer::Query& query,
+                               DocumentStatus status_to_find,
+                               size_t max_document_count);
+
+    inline Shard& GetShard(const std::string& key) const {
+        return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    // Drops entries of shard computed by an older index,
+    // the mutex of shard must be held
+    void Invalidate(Shard& shard) const;
+
+    // Returns false if the key is not cached
+    bool Find(const std::string& key, std::vector<Document>& documents);
+
+    void Insert(std::string key, const std::vector<Document>& documents);
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Dense relevance scores of a query over a range of document ordinals.
+// Every thread reuses its own accumulator between queries: only the entries
+// touched by the previous query are cleared, so a query does not allocate
+// or clear memory proportional to the document count.
+class RelevanceAccumulator {
+public:
+    // Accumulator of the calling thread cleared for size ordinals
+    static RelevanceAccumulator& Get(size_t size) {
+        thread_local RelevanceAccumulator accumulator;
+        accumulator.Reset(size);
+        return accumulator;
+    }
+
+    inline bool IsUntouched(size_t i) const {
+        return states_[i] == State::UNTOUCHED;
+    }
+
+    inline bool IsMatched(size_t i) const {
+        return states_[i] == State::MATCHED;
+    }
+
+    inline void Match(size_t i) {
+        states_[i] = State::MATCHED;
+        touched_.push_back(i);
+        matched_.push_back(i);
+    }
+
+    inline void Exclude(size_t i) {
+        if (states_[i] == State::UNTOUCHED)
+            touched_.push_back(i);
+        states_[i] = State::EXCLUDED;
+    }
+
+    inline void Add(size_t i, double relevance) {
+        relevances_[i] += relevance;
+    }
+
+    inline double GetRelevance(size_t i) const {
+        return relevances_[i];
+    }
+
+    // Matched entries in order of their first match
+    inline const std::vector<uint32_t>& GetMatched() const noexcept {
+        return matched_;
+    }
+
+private:
+    enum class State : uint8_t {
+        UNTOUCHED,
+        MATCHED,
+        EXCLUDED,
+    };
+
+    std::vector<double> relevances_;
+    std::vector<State> states_;
+    std::vector<uint32_t> touched_;
+    std::vector<uint32_t> matched_;
+
+    RelevanceAccumulator() = default;
+
+    void Reset(size_t size) {
+        for (const uint32_t i : touched_) {
+            relevances_[i] = 0.0;
+            states_[i] = State::UNTOUCHED;
+        }
+        touched_.clear();
+        matched_.clear();
+
+        if (relevances_.size() < size) {
+            relevances_.resize(size);
+            states_.resize(size);
+        }
+    }
+};
@@ -1,37 +1,82 @@
 #include "remove_duplicates.h"
 
-template <typename Key, typename Value>
-bool IsKeysEqual(
-    const std::map<Key, Value>& lhs,
-    const std::map<Key, Value>& rhs
-)
-{
-    return lhs.size() == rhs.size()
-        && std::equal(
-            lhs.begin(), lhs.end(),
-            rhs.begin(),
-            [](const auto& a, const auto& b) { return a.first == b.first; }
-        );
-}
-
-void RemoveDuplicates(SearchServer& search_server) {
-    std::vector<int> duplicate_ids;
-
-    for (int outer_doc_id : search_server) {
-        const std::map<std::string_view, double>& word_to_freq = search_server.GetWordFrequencies(outer_doc_id);
-
-        for (int inner_doc_id : search_server) {
-            if (outer_doc_id == inner_doc_id
-                || binary_search(duplicate_ids.begin(), duplicate_ids.end(), outer_doc_id))
-                break;
-
-            if (IsKeysEqual(word_to_freq, search_server.GetWordFrequencies(inner_doc_id)))
-                duplicate_ids.push_back(outer_doc_id);
+std::vector<int> FindDuplicates(const SearchServer& search_server) {
+    return FindDuplicates(std::execution::seq, search_server);
+}
+
+std::vector<int> RemoveDuplicates(SearchServer& search_server) {
+    return RemoveDuplicates(std::execution::seq, search_server);
+}
+
+size_t HashDocumentTerms(const std::pmr::vector<int>& terms) {
+    size_t hash = terms.size();
+    for (const int term : terms)
+        hash ^= std::hash<int>{}(term) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+std::vector<int> FindNearDuplicates(const SearchServer& search_server,
+                                    const NearDuplicateOptions& options) {
+    return FindNearDuplicates(std::execution::seq, search_server, options);
+}
+
+std::vector<int> RemoveNearDuplicates(SearchServer& search_server,
+                                      const NearDuplicateOptions& options) {
+    return RemoveNearDuplicates(std::execution::seq, search_server, options);
+}
+
+void ThrowInvalidNearDuplicateOptions(const NearDuplicateOptions& options) {
+    if (options.band_count <= 0 || options.band_rows <= 0)
+        throw std::invalid_argument("band count and band rows must be positive");
+    if (options.jaccard_threshold < 0.0 || options.jaccard_threshold > 1.0)
+        throw std::invalid_argument("jaccard threshold must be in [0, 1]");
+    if (options.max_band_candidates <= 0)
+        throw std::invalid_argument("max band candidates must be positive");
+}
+
+// SplitMix64 finalizer, a cheap well-mixing hash of 64-bit integers
+static uint64_t MixBits(uint64_t x) {
+    x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27))*0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+void ComputeMinHashSignature(const std::pmr::vector<int>& terms,
+                             uint32_t* signature, size_t length) {
+    std::fill(signature, signature + length, UINT32_MAX);
+    for (const int term : terms) {
+        const uint64_t term_hash = MixBits(static_cast<uint32_t>(term));
+        for (size_t i = 0; i < length; ++i) {
+            const uint32_t hash = MixBits(term_hash + i*0x9e3779b97f4a7c15) >> 32;
+            signature[i] = std::min(signature[i], hash);
         }
     }
+}
 
-    for (int duplicate_id : duplicate_ids) {
-        std::cout << "Found duplicate document id " << duplicate_id << std::endl;
-        search_server.RemoveDocument(duplicate_id);
+size_t HashBand(const uint32_t* rows, size_t row_count) {
+    uint64_t hash = row_count;
+    for (size_t i = 0; i < row_count; ++i)
+        hash = MixBits(hash ^ rows[i]);
+    return hash;
+}
+
+double ComputeJaccardIndex(const std::pmr::vector<int>& lhs,
+                           const std::pmr::vector<int>& rhs) {
+    if (lhs.empty() && rhs.empty())
+        return 1.0;
+
+    size_t intersection_size = 0;
+    for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end() && r != rhs.end();) {
+        if (*l < *r) {
+            ++l;
+        } else if (*r < *l) {
+            ++r;
+        } else {
+            ++intersection_size;
+            ++l;
+            ++r;
+        }
     }
+    return static_cast<double>(intersection_size)
+         / (lhs.size() + rhs.size() - intersection_size);
 }
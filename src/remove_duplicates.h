@@ -1,7 +1,263 @@
 #pragma once
 #include <algorithm>
+#include <execution>
+#include <cstdint>
 #include <iostream>
+#include <memory_resource>
+#include <numeric>
+#include <vector>
 
 #include "search_server.h"
 
-void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
+// Ids of documents with the same set of words as a document met earlier
+// by the iteration over the search server, in the order of that iteration
+std::vector<int> FindDuplicates(const SearchServer& search_server);
+
+template <typename ExecutionPolicy>
+std::vector<int> FindDuplicates(ExecutionPolicy execution_policy,
+                                const SearchServer& search_server);
+
+// Removes the documents found by FindDuplicates() and returns their ids
+std::vector<int> RemoveDuplicates(SearchServer& search_server);
+
+template <typename ExecutionPolicy>
+std::vector<int> RemoveDuplicates(ExecutionPolicy execution_policy,
+                                  SearchServer& search_server);
+
+size_t HashDocumentTerms(const std::pmr::vector<int>& terms);
+
+// Near-duplicate detection by MinHash signatures of the word sets of
+// documents. A signature is split into bands: documents sharing a band
+// become candidates, and a candidate is a duplicate if the Jaccard index of
+// its word set and of the word set of an earlier kept document reaches the
+// threshold. With b bands of r rows a pair with Jaccard index s becomes a
+// candidate with probability 1 - (1 - s^r)^b.
+struct NearDuplicateOptions {
+    int band_count = 16;
+    int band_rows = 4;
+    double jaccard_threshold = 0.8;
+    // Documents sharing a band are compared with at most that many
+    // preceding documents of the band, which bounds the work on large buckets
+    int max_band_candidates = 32;
+};
+
+std::vector<int> FindNearDuplicates(const SearchServer& search_server,
+                                    const NearDuplicateOptions& options = {});
+
+template <typename ExecutionPolicy>
+std::vector<int> FindNearDuplicates(ExecutionPolicy execution_policy,
+                                    const SearchServer& search_server,
+                                    const NearDuplicateOptions& options = {});
+
+std::vector<int> RemoveNearDuplicates(SearchServer& search_server,
+                                      const NearDuplicateOptions& options = {});
+
+template <typename ExecutionPolicy>
+std::vector<int> RemoveNearDuplicates(ExecutionPolicy execution_policy,
+                                      SearchServer& search_server,
+                                      const NearDuplicateOptions& options = {});
+
+void ThrowInvalidNearDuplicateOptions(const NearDuplicateOptions& options);
+
+void ComputeMinHashSignature(const std::pmr::vector<int>& terms,
+                             uint32_t* signature, size_t length);
+
+size_t HashBand(const uint32_t* rows, size_t row_count);
+
+double ComputeJaccardIndex(const std::pmr::vector<int>& lhs,
+                           const std::pmr::vector<int>& rhs);
+
+
+/* ------------------------------- TEMPLATES ------------------------------- */
+
+template <typename ExecutionPolicy>
+std::vector<int> FindDuplicates(ExecutionPolicy execution_policy,
+                                const SearchServer& search_server)
+{
+    const std::vector<int> documents_ids(search_server.begin(), search_server.end());
+
+    // Hash of the words of every document with its position in the iteration.
+    // Parallel algorithms may copy elements, so positions are iterated
+    // instead of the addresses of ids
+    std::vector<size_t> positions(documents_ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::vector<std::pair<size_t, size_t>> hash_to_position(documents_ids.size());
+    std::transform(
+        execution_policy,
+        positions.begin(), positions.end(),
+        hash_to_position.begin(),
+        [&search_server, &documents_ids](size_t position) {
+            return std::pair<size_t, size_t>{
+                HashDocumentTerms(search_server.GetDocumentTerms(documents_ids[position])),
+                position
+            };
+        }
+    );
+    std::sort(execution_policy, hash_to_position.begin(), hash_to_position.end());
+
+    // Documents with equal hashes follow in the order of the iteration, so the
+    // first one of every set of words is kept and the others are duplicates
+    std::vector<size_t> duplicate_positions;
+    std::vector<const std::pmr::vector<int>*> kept_terms;
+    for (auto first = hash_to_position.begin(); first != hash_to_position.end();) {
+        const auto last = std::find_if(
+            first, hash_to_position.end(),
+            [first](const auto& item) { return item.first != first->first; }
+        );
+
+        kept_terms.clear();
+        for (; first != last; ++first) {
+            const std::pmr::vector<int>& terms = search_server.GetDocumentTerms(
+                documents_ids[first->second]
+            );
+            const bool is_duplicate = std::any_of(
+                kept_terms.begin(), kept_terms.end(),
+                [&terms](const std::pmr::vector<int>* kept) { return *kept == terms; }
+            );
+            if (is_duplicate)
+                duplicate_positions.push_back(first->second);
+            else
+                kept_terms.push_back(&terms);
+        }
+    }
+    std::sort(execution_policy, duplicate_positions.begin(), duplicate_positions.end());
+
+    std::vector<int> duplicate_ids;
+    duplicate_ids.reserve(duplicate_positions.size());
+    for (const size_t position : duplicate_positions)
+        duplicate_ids.push_back(documents_ids[position]);
+    return duplicate_ids;
+}
+
+template <typename ExecutionPolicy>
+std::vector<int> RemoveDuplicates(ExecutionPolicy execution_policy,
+                                  SearchServer& search_server)
+{
+    const std::vector<int> duplicate_ids = FindDuplicates(execution_policy, search_server);
+    for (const int duplicate_id : duplicate_ids) {
+        std::cout << "Found duplicate document id " << duplicate_id << std::endl;
+        search_server.RemoveDocument(execution_policy, duplicate_id);
+    }
+    return duplicate_ids;
+}
+
+template <typename ExecutionPolicy>
+std::vector<int> FindNearDuplicates(ExecutionPolicy execution_policy,
+                                    const SearchServer& search_server,
+                                    const NearDuplicateOptions& options)
+{
+    ThrowInvalidNearDuplicateOptions(options);
+
+    const std::vector<int> documents_ids(search_server.begin(), search_server.end());
+    const size_t band_count = options.band_count;
+    const size_t band_rows = options.band_rows;
+    const size_t signature_length = band_count*band_rows;
+
+    std::vector<size_t> positions(documents_ids.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::vector<uint32_t> signatures(documents_ids.size()*signature_length);
+    std::for_each(
+        execution_policy,
+        positions.begin(), positions.end(),
+        [&](size_t position) {
+            ComputeMinHashSignature(search_server.GetDocumentTerms(documents_ids[position]),
+                                    &signatures[position*signature_length],
+                                    signature_length);
+        }
+    );
+
+    // Candidate pairs of every band packed as (later position, earlier position)
+    std::vector<std::vector<uint64_t>> band_candidates(band_count);
+    std::for_each(
+        execution_policy,
+        band_candidates.begin(), band_candidates.end(),
+        [&](std::vector<uint64_t>& candidates) {
+            const size_t band = &candidates - band_candidates.data();
+
+            std::vector<std::pair<size_t, uint32_t>> hash_to_position(documents_ids.size());
+            for (uint32_t position = 0; position < hash_to_position.size(); ++position) {
+                hash_to_position[position] = {
+                    HashBand(&signatures[position*signature_length + band*band_rows], band_rows),
+                    position
+                };
+            }
+            std::sort(hash_to_position.begin(), hash_to_position.end());
+
+            for (size_t first = 0, last = 0; first < hash_to_position.size(); first = last) {
+                while (last < hash_to_position.size()
+                       && hash_to_position[last].first == hash_to_position[first].first)
+                    ++last;
+
+                for (size_t i = first + 1; i < last; ++i) {
+                    const size_t first_candidate = std::max(
+                        first, i - std::min<size_t>(i, options.max_band_candidates)
+                    );
+                    for (size_t j = first_candidate; j < i; ++j) {
+                        candidates.push_back(
+                            static_cast<uint64_t>(hash_to_position[i].second) << 32
+                            | hash_to_position[j].second
+                        );
+                    }
+                }
+            }
+        }
+    );
+    signatures.clear();
+    signatures.shrink_to_fit();
+
+    std::vector<uint64_t> candidates;
+    candidates.reserve(std::transform_reduce(
+        band_candidates.begin(), band_candidates.end(), size_t{0}, std::plus<>{},
+        [](const std::vector<uint64_t>& band) { return band.size(); }
+    ));
+    for (std::vector<uint64_t>& band : band_candidates) {
+        candidates.insert(candidates.end(), band.begin(), band.end());
+        band = {};
+    }
+    std::sort(execution_policy, candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<char> is_similar(candidates.size());
+    std::transform(
+        execution_policy,
+        candidates.begin(), candidates.end(),
+        is_similar.begin(),
+        [&](const uint64_t candidate) -> char {
+            return ComputeJaccardIndex(
+                search_server.GetDocumentTerms(documents_ids[candidate >> 32]),
+                search_server.GetDocumentTerms(documents_ids[candidate & UINT32_MAX])
+            ) >= options.jaccard_threshold;
+        }
+    );
+
+    // Candidates are ordered by the later document, so whether the earlier
+    // one is kept is known by the time the later one is checked
+    std::vector<char> is_duplicate(documents_ids.size());
+    std::vector<int> duplicate_ids;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const size_t position = candidates[i] >> 32;
+        if (is_similar[i]
+            && !is_duplicate[position]
+            && !is_duplicate[candidates[i] & UINT32_MAX])
+        {
+            is_duplicate[position] = true;
+            duplicate_ids.push_back(documents_ids[position]);
+        }
+    }
+    return duplicate_ids;
+}
+
+template <typename ExecutionPolicy>
+std::vector<int> RemoveNearDuplicates(ExecutionPolicy execution_policy,
+                                      SearchServer& search_server,
+                                      const NearDuplicateOptions& options)
+{
+    const std::vector<int> duplicate_ids = FindNearDuplicates(
+        execution_policy, search_server, options
+    );
+    for (const int duplicate_id : duplicate_ids) {
+        std::cout << "Found near duplicate document id " << duplicate_id << std::endl;
+        search_server.RemoveDocument(execution_policy, duplicate_id);
+    }
+    return duplicate_ids;
+}
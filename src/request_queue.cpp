@@ -5,15 +5,15 @@ std::vector<Document> RequestQueue::AddFindRequest(
     DocumentStatus status
 )
 {
-    const std::vector<Document>& found_documents = search_server_.FindTopDocuments(raw_query, status);
+    const std::vector<Document> found_documents = cache_
+        ? cache_->FindTopDocuments(raw_query, status)
+        : search_server_.FindTopDocuments(raw_query, status);
     UpdateRequestQueue(found_documents.empty());
     return found_documents;
 }
 
 std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
-    const std::vector<Document> found_documents = search_server_.FindTopDocuments(raw_query);
-    UpdateRequestQueue(found_documents.empty());
-    return found_documents;
+    return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
 }
 
 void RequestQueue::UpdateRequestQueue(const bool is_empty) {
@@ -3,6 +3,7 @@
 #include <vector>
 #include <utility>
 
+#include "query_result_cache.h"
 #include "search_server.h"
 
 template <typename InputIt>
@@ -33,6 +34,14 @@ public:
     {
     }
 
+    // Requests by status are answered from the cache,
+    // requests by a predicate go to its server
+    explicit RequestQueue(QueryResultCache& cache)
+        : search_server_(cache.GetSearchServer())
+        , cache_(&cache)
+    {
+    }
+
     template <typename DocumentPredicate>
     std::vector<Document> AddFindRequest(const std::string& raw_query,
                                          DocumentPredicate document_predicate) {
@@ -56,6 +65,7 @@ public:
 private:
     const static int sec_in_day_ = 1440;
     const SearchServer& search_server_;
+    QueryResultCache* cache_ = nullptr;
     std::deque<bool> requests_;
     int no_result_count_ = 0;
 
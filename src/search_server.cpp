@@ -4,9 +4,95 @@ const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(
     int document_id
 ) const {
     const static std::map<std::string_view, double> document_to_empty_freqs;
-    return document_to_word_freqs_.count(document_id)
-           ? document_to_word_freqs_.at(document_id)
-           : document_to_empty_freqs;
+    if (!document_to_ordinal_.count(document_id))
+        return document_to_empty_freqs;
+
+    std::lock_guard<std::mutex> lock(word_freqs_mutex_);
+    WordFrequencies& word_freqs = document_to_word_freqs_[document_id];
+    if (word_freqs.generation != generation_) {
+        const int ordinal = document_to_ordinal_.at(document_id);
+        for (const int term_id : document_terms_[ordinal])
+            word_freqs.word_to_freq[terms_.GetWord(term_id)] = ComputeTermInverseDocumentFreq(term_id);
+        word_freqs.generation = generation_;
+    }
+    return word_freqs.word_to_freq;
+}
+
+SearchServer::SearchServer(const SearchServer& other)
+    : stop_words_(other.stop_words_)
+    , terms_(other.terms_)
+    , term_to_document_freqs_(other.term_to_document_freqs_)
+    , document_to_ordinal_(other.document_to_ordinal_, memory_.get())
+    , ordinal_to_document_(other.ordinal_to_document_)
+    , statuses_(other.statuses_)
+    , ratings_(other.ratings_)
+    , document_terms_(other.document_terms_, memory_.get())
+    , generation_(other.generation_)
+{
+    // Cached word frequencies are views of the words of other,
+    // so they are computed again for the copy
+}
+
+SearchServer::SearchServer(SearchServer&& other)
+    : memory_(std::move(other.memory_))
+    , stop_words_(std::move(other.stop_words_))
+    , terms_(std::move(other.terms_))
+    , term_to_document_freqs_(std::move(other.term_to_document_freqs_))
+    , document_to_ordinal_(std::move(other.document_to_ordinal_))
+    , ordinal_to_document_(std::move(other.ordinal_to_document_))
+    , statuses_(std::move(other.statuses_))
+    , ratings_(std::move(other.ratings_))
+    , document_terms_(std::move(other.document_terms_))
+    , generation_(other.generation_)
+    , document_to_word_freqs_(std::move(other.document_to_word_freqs_))
+{
+    // The cache moves along with the words it views, while the mutex
+    // is a new one
+}
+
+SearchServer& SearchServer::operator=(const SearchServer& other) {
+    if (this != &other) {
+        stop_words_ = other.stop_words_;
+        terms_ = other.terms_;
+        term_to_document_freqs_ = other.term_to_document_freqs_;
+        document_to_ordinal_ = other.document_to_ordinal_;
+        ordinal_to_document_ = other.ordinal_to_document_;
+        statuses_ = other.statuses_;
+        ratings_ = other.ratings_;
+        document_terms_ = other.document_terms_;
+        OnAssigned(other.generation_);
+    }
+    return *this;
+}
+
+SearchServer& SearchServer::operator=(SearchServer&& other) {
+    if (this != &other) {
+        stop_words_ = std::move(other.stop_words_);
+        terms_ = std::move(other.terms_);
+        term_to_document_freqs_ = std::move(other.term_to_document_freqs_);
+        document_to_ordinal_ = std::move(other.document_to_ordinal_);
+        ordinal_to_document_ = std::move(other.ordinal_to_document_);
+        statuses_ = std::move(other.statuses_);
+        ratings_ = std::move(other.ratings_);
+        document_terms_ = std::move(other.document_terms_);
+        OnAssigned(other.generation_);
+    }
+    return *this;
+}
+
+void SearchServer::OnAssigned(uint64_t other_generation) {
+    // A generation newer than both tells caches of this server
+    // that its corpus has changed
+    generation_ = std::max(generation_, other_generation) + 1;
+    document_to_word_freqs_.clear();
+}
+
+const std::pmr::vector<int>& SearchServer::GetDocumentTerms(int document_id) const {
+    const static std::pmr::vector<int> empty_terms;
+    const auto it = document_to_ordinal_.find(document_id);
+    return it != document_to_ordinal_.end()
+        ? document_terms_[it->second]
+        : empty_terms;
 }
 
 void SearchServer::AddDocument(
@@ -16,69 +102,94 @@ void SearchServer::AddDocument(
     const std::vector<int>& ratings
 )
 {
-    if (documents_.count(document_id))
-        throw std::invalid_argument(
-            "already used id --> " + std::to_string(document_id)
-        );
-    else if (document_id < 0)
-        throw std::invalid_argument(
-            "negative document id --> " + std::to_string(document_id)
-        );
+    ThrowInvalidDocumentId(document_id);
 
-    const std::vector<std::string> words = ThrowInvalidWords(
-        SplitIntoWordsNoStop(text)
-    );
-    const double inv_word_count = 1.0/words.size();
-    for (const std::string& word : words)
-        word_to_document_freqs_[word][document_id] += inv_word_count;
+    TokenizedDocument document = TokenizeDocument({document_id, text, status, ratings});
+    if (!document.is_valid)
+        ThrowInvalidWords(document.words);
 
-    documents_.emplace(document_id, DocumentData(words, status, ratings));
-    documents_ids_.push_back(document_id);
+    const int ordinal = AppendDocument(document_id, document.status, document.rating);
+    document_terms_[ordinal].reserve(document.word_freqs.size());
+    for (const auto& [word, term_freq] : document.word_freqs) {
+        const int term_id = terms_.Add(word);
+        GetTermPostings(term_id).Add(ordinal, term_freq);
+        document_terms_[ordinal].push_back(term_id);
+    }
+    std::sort(document_terms_[ordinal].begin(), document_terms_[ordinal].end());
 
-    UpdateInverseDocumentFreqs();
+    ++generation_;
+}
+
+void SearchServer::IndexDocuments(
+    const std::vector<RawDocument>& documents,
+    const std::vector<TokenizedDocument>& tokenized_documents
+)
+{
+    // A hash lookup of every distinct word of a document is cheaper
+    // than ordering all postings of the batch by word
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const int ordinal = AppendDocument(documents[i].id,
+                                           tokenized_documents[i].status,
+                                           tokenized_documents[i].rating);
+        std::pmr::vector<int>& terms = document_terms_[ordinal];
+        terms.reserve(tokenized_documents[i].word_freqs.size());
+        for (const auto& [word, term_freq] : tokenized_documents[i].word_freqs) {
+            const int term_id = terms_.Add(word);
+            GetTermPostings(term_id).Add(ordinal, term_freq);
+            terms.push_back(term_id);
+        }
+        std::sort(terms.begin(), terms.end());
+    }
+
+    ++generation_;
 }
 
 void SearchServer::RemoveDocument(std::execution::sequenced_policy,
                                   int document_id) {
-    if (documents_.count(document_id)) {
-        for (const std::string& word : documents_.at(document_id).unique_words)
-            word_to_document_freqs_.at(word).erase(document_id);
-
-        documents_.erase(document_id);
-        documents_ids_.erase(
-            remove(documents_ids_.begin(), documents_ids_.end(), document_id),
-            documents_ids_.end()
-        );
+    const auto it = document_to_ordinal_.find(document_id);
+    if (it == document_to_ordinal_.end())
+        return;
 
-        UpdateInverseDocumentFreqs();
+    const int ordinal = it->second;
+    for (const int term_id : document_terms_[ordinal]) {
+        term_to_document_freqs_[term_id].Erase(ordinal);
+        ReleaseTermIfUnused(term_id);
     }
+
+    EraseDocument(document_id, ordinal);
+    CompactDocuments();
+    ++generation_;
 }
 
 void SearchServer::RemoveDocument(std::execution::parallel_policy,
                                   int document_id) {
-    if (documents_.count(document_id)) {
-        std::for_each(
-            std::execution::par,
-            documents_.at(document_id).unique_words.begin(),
-            documents_.at(document_id).unique_words.end(),
-            [&, document_id](const std::string& word) {
-                word_to_document_freqs_.at(word).erase(document_id);
-            }
-        );
-
-        documents_.erase(document_id);
-        documents_ids_.erase(
-            remove(
-                std::execution::par,
-                documents_ids_.begin(),
-                documents_ids_.end(),
-                document_id
-            ),
-            documents_ids_.end()
-        );
+    const auto it = document_to_ordinal_.find(document_id);
+    if (it == document_to_ordinal_.end())
+        return;
 
-        UpdateInverseDocumentFreqs();
+    const int ordinal = it->second;
+    const std::pmr::vector<int>& terms = document_terms_[ordinal];
+    if (terms.size() < parallel_erase_size_) {
+        RemoveDocument(std::execution::seq, document_id);
+        return;
     }
+
+    // Terms of a document are distinct, so every task erases from a posting
+    // list of its own, and no container of the server changes its size
+    // until the tasks are done
+    std::for_each(
+        std::execution::par,
+        terms.begin(), terms.end(),
+        [this, ordinal](int term_id) {
+            term_to_document_freqs_[term_id].Erase(ordinal);
+        }
+    );
+    for (const int term_id : terms)
+        ReleaseTermIfUnused(term_id);
+
+    EraseDocument(document_id, ordinal);
+    CompactDocuments();
+    ++generation_;
 }
 
 bool SearchServer::IsValidWord(const std::string_view& word) {
@@ -87,17 +198,131 @@ bool SearchServer::IsValidWord(const std::string_view& word) {
     });
 }
 
-std::vector<std::string> SearchServer::SplitIntoWordsNoStop(
+bool SearchServer::IsValidWords(const std::vector<std::string_view>& words) {
+    return std::all_of(words.begin(), words.end(), IsValidWord);
+}
+
+void SearchServer::ThrowInvalidDocumentId(int document_id) const {
+    if (document_to_ordinal_.count(document_id))
+        throw std::invalid_argument(
+            "already used id --> " + std::to_string(document_id)
+        );
+    else if (document_id < 0)
+        throw std::invalid_argument(
+            "negative document id --> " + std::to_string(document_id)
+        );
+}
+
+void SearchServer::ThrowInvalidDocumentIds(const std::vector<RawDocument>& documents) const {
+    std::set<int> batch_ids;
+    for (const RawDocument& document : documents) {
+        ThrowInvalidDocumentId(document.id);
+        if (!batch_ids.insert(document.id).second)
+            throw std::invalid_argument(
+                "already used id --> " + std::to_string(document.id)
+            );
+    }
+}
+
+int SearchServer::AppendDocument(int document_id,
+                                 DocumentStatus status,
+                                 int rating) {
+    const int ordinal = ordinal_to_document_.size();
+    document_to_ordinal_.emplace(document_id, ordinal);
+    ordinal_to_document_.push_back(document_id);
+    statuses_.push_back(status);
+    ratings_.push_back(rating);
+    document_terms_.emplace_back();
+    return ordinal;
+}
+
+PostingList& SearchServer::GetTermPostings(int term_id) {
+    if (static_cast<size_t>(term_id) >= term_to_document_freqs_.size())
+        term_to_document_freqs_.resize(term_id + 1);
+    return term_to_document_freqs_[term_id];
+}
+
+void SearchServer::EraseDocument(int document_id, int ordinal) {
+    document_to_word_freqs_.erase(document_id);
+    document_to_ordinal_.erase(document_id);
+    ordinal_to_document_[ordinal] = -1;
+    // Assigning an empty vector of another allocator would keep the memory
+    document_terms_[ordinal].clear();
+    document_terms_[ordinal].shrink_to_fit();
+}
+
+void SearchServer::ReleaseTermIfUnused(int term_id) {
+    if (term_to_document_freqs_[term_id].empty())
+        terms_.Remove(term_id);
+}
+
+void SearchServer::CompactDocuments() {
+    if (document_to_ordinal_.size()*2 >= ordinal_to_document_.size())
+        return;
+
+    std::vector<int> new_ordinals(ordinal_to_document_.size(), -1);
+    size_t new_ordinal = 0;
+    for (size_t ordinal = 0; ordinal < ordinal_to_document_.size(); ++ordinal) {
+        if (ordinal_to_document_[ordinal] < 0)
+            continue;
+
+        new_ordinals[ordinal] = new_ordinal;
+        if (new_ordinal != ordinal) {
+            ordinal_to_document_[new_ordinal] = ordinal_to_document_[ordinal];
+            statuses_[new_ordinal] = statuses_[ordinal];
+            ratings_[new_ordinal] = ratings_[ordinal];
+            document_terms_[new_ordinal] = std::move(document_terms_[ordinal]);
+            document_to_ordinal_[ordinal_to_document_[new_ordinal]] = new_ordinal;
+        }
+        ++new_ordinal;
+    }
+    ordinal_to_document_.resize(new_ordinal);
+    statuses_.resize(new_ordinal);
+    ratings_.resize(new_ordinal);
+    document_terms_.resize(new_ordinal);
+
+    for (PostingList& postings : term_to_document_freqs_)
+        postings.Renumber(new_ordinals);
+}
+
+std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(
     const std::string_view& text
 ) const
 {
-    std::vector<std::string> words;
-    for (const std::string& word : SplitIntoWords(text))
+    // Reserving for every space saves reallocations of a growing vector
+    std::vector<std::string_view> words;
+    words.reserve(std::count(text.begin(), text.end(), ' ') + 1);
+    ForEachWord(text, [this, &words](std::string_view word) {
         if (!IsStopWord(word))
             words.push_back(word);
+    });
     return words;
 }
 
+SearchServer::TokenizedDocument SearchServer::TokenizeDocument(
+    const RawDocument& raw_document
+) const
+{
+    TokenizedDocument document{SplitIntoWordsNoStop(raw_document.text), {}, {}, 0, true};
+    document.is_valid = IsValidWords(document.words);
+    if (!document.is_valid)
+        return document;
+
+    document.status = raw_document.status;
+    document.rating = ComputeAverageRating(raw_document.ratings);
+
+    std::sort(document.words.begin(), document.words.end());
+    document.word_freqs.reserve(document.words.size());
+
+    const double inv_word_count = 1.0/document.words.size();
+    for (const std::string_view& word : document.words) {
+        if (document.word_freqs.empty() || document.word_freqs.back().first != word)
+            document.word_freqs.emplace_back(word, 0.0);
+        document.word_freqs.back().second += inv_word_count;
+    }
+    return document;
+}
+
 int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     if (ratings.size()) {
         int rating_sum = 0;
@@ -110,41 +335,239 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
 }
 
 SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view word) const {
-    bool is_minus = (word[0] == '-');
+    bool is_minus = (!word.empty() && word[0] == '-');
     if (is_minus)
         word = word.substr(1);
     return {word, is_minus, IsStopWord(word)};
 }
 
-SearchServer::Query SearchServer::ThrowInvalidQuery(const Query& query) {
+void SearchServer::AddQueryWord(const QueryWord& query_word, Query& query) {
+    if (query_word.is_stop)
+        return;
+    else if (query_word.is_minus)
+        query.minus_words.push_back(query_word.data);
+    else if (!query_word.data.empty())
+        query.plus_words.push_back(query_word.data);
+}
+
+void SearchServer::ThrowInvalidQuery(const Query& query) {
     ThrowInvalidWords(query.plus_words);
     ThrowInvalidWords(query.minus_words);
     ThrowInvalidWords(
         query.minus_words,
-        [](const std::string& word){ return word[0] == '-' || word.empty(); }
+        [](const std::string_view& word){ return word.empty() || word[0] == '-'; }
     );
-    return query;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(
-    const std::string& word
+DocumentStatus SearchServer::MatchDocument(
+    std::execution::sequenced_policy,
+    const std::string_view& raw_query,
+    int document_id,
+    std::vector<std::string_view>& matched_words
 ) const
 {
-    return (word_to_document_freqs_.at(word).size())
-            ? log(static_cast<double>(GetDocumentCount())/word_to_document_freqs_.at(word).size())
+    // Keeps its capacity between calls, so matching a document
+    // doesn't allocate once the buffers are large enough
+    thread_local Query query;
+    ParseQuery(std::execution::seq, raw_query, query);
+    ThrowInvalidQuery(query);
+    return MatchQuery(query, document_id, matched_words);
+}
+
+DocumentStatus SearchServer::MatchQuery(
+    const Query& query,
+    int document_id,
+    std::vector<std::string_view>& matched_words
+) const
+{
+    const int ordinal = document_to_ordinal_.at(document_id);
+
+    matched_words.clear();
+    for (const std::string_view& word : query.minus_words)
+        if (IsDocumentContainWord(ordinal, word))
+            return statuses_[ordinal];
+
+    for (const std::string_view& word : query.plus_words)
+        if (IsDocumentContainWord(ordinal, word))
+            matched_words.push_back(word);
+    return statuses_[ordinal];
+}
+
+double SearchServer::ComputeTermInverseDocumentFreq(int term_id) const {
+    const size_t document_freq = term_to_document_freqs_[term_id].size();
+    return (document_freq)
+            ? log(static_cast<double>(GetDocumentCount())/document_freq)
             : 0;
 }
 
-std::vector<Document> SearchServer::ConvertToMatchedDocuments(
-    std::map<int, double> document_to_relevance
+int SearchServer::GetDocumentFreq(std::string_view word) const {
+    const int term_id = terms_.Find(word);
+    return term_id != TermDictionary::NOT_FOUND
+        ? term_to_document_freqs_[term_id].size()
+        : 0;
+}
+
+SearchServer::QueryPostings SearchServer::FindQueryPostings(
+    const Query& query,
+    const std::vector<double>& inverse_document_freqs
 ) const
 {
-    std::vector<Document> matched_documents;
-    for (const auto& [document_id, relevance] : document_to_relevance)
-        matched_documents.push_back({
-            document_id,
-            relevance,
-            documents_.at(document_id).rating
+    QueryPostings query_postings;
+    for (size_t i = 0; i < query.plus_words.size(); ++i) {
+        const int term_id = terms_.Find(query.plus_words[i]);
+        if (term_id != TermDictionary::NOT_FOUND)
+            query_postings.plus.push_back({
+                &term_to_document_freqs_[term_id],
+                inverse_document_freqs[i]
+            });
+    }
+    for (const std::string_view& word : query.minus_words) {
+        const int term_id = terms_.Find(word);
+        if (term_id != TermDictionary::NOT_FOUND)
+            query_postings.minus.push_back(&term_to_document_freqs_[term_id]);
+    }
+    return query_postings;
+}
+
+SearchServer::QueryPostings SearchServer::FindQueryPostings(
+    const Query& query
+) const
+{
+    QueryPostings query_postings;
+    for (const std::string_view& word : query.plus_words) {
+        const int term_id = terms_.Find(word);
+        if (term_id != TermDictionary::NOT_FOUND)
+            query_postings.plus.push_back({
+                &term_to_document_freqs_[term_id],
+                ComputeTermInverseDocumentFreq(term_id)
+            });
+    }
+    for (const std::string_view& word : query.minus_words) {
+        const int term_id = terms_.Find(word);
+        if (term_id != TermDictionary::NOT_FOUND)
+            query_postings.minus.push_back(&term_to_document_freqs_[term_id]);
+    }
+    return query_postings;
+}
+
+static void WriteIndexFileSection(std::ofstream& out,
+                                  const void* data,
+                                  size_t size,
+                                  uint64_t& checksum) {
+    static const char padding[INDEX_FILE_ALIGNMENT] = {};
+    const size_t padding_size = AlignIndexFileSize(size) - size;
+
+    out.write(static_cast<const char*>(data), size);
+    out.write(padding, padding_size);
+    checksum = ComputeIndexFileChecksum(static_cast<const char*>(data), size, checksum);
+    checksum = ComputeIndexFileChecksum(padding, padding_size, checksum);
+}
+
+template <typename T>
+static void WriteIndexFileSection(std::ofstream& out,
+                                  const std::vector<T>& data,
+                                  uint64_t& checksum) {
+    WriteIndexFileSection(out, data.data(), data.size()*sizeof(T), checksum);
+}
+
+void SearchServer::Save(const std::string& path) const {
+    static_assert(sizeof(int) == sizeof(int32_t), "ordinals are stored as int32_t");
+
+    // Documents are renumbered in order of ids, skipping holes
+    std::vector<int> new_ordinals(ordinal_to_document_.size(), -1);
+    std::vector<int32_t> document_ids;
+    std::vector<int32_t> document_statuses;
+    std::vector<int32_t> document_ratings;
+    for (const auto& [document_id, ordinal] : document_to_ordinal_) {
+        new_ordinals[ordinal] = document_ids.size();
+        document_ids.push_back(document_id);
+        document_statuses.push_back(static_cast<int32_t>(statuses_[ordinal]));
+        document_ratings.push_back(ratings_[ordinal]);
+    }
+
+    // Terms are renumbered in order of words, skipping free term ids
+    std::vector<std::pair<std::string_view, int>> words;
+    for (size_t term_id = 0; term_id < term_to_document_freqs_.size(); ++term_id)
+        if (!term_to_document_freqs_[term_id].empty())
+            words.emplace_back(terms_.GetWord(term_id), term_id);
+    std::sort(words.begin(), words.end());
+
+    std::vector<int> new_term_ids(term_to_document_freqs_.size(), -1);
+    std::string words_data;
+    std::vector<uint64_t> term_word_offsets{0};
+    std::vector<uint64_t> term_posting_offsets{0};
+    std::vector<int32_t> posting_ordinals;
+    std::vector<double> posting_term_freqs;
+    std::vector<std::pair<int, double>> postings;
+    for (const auto& [word, term_id] : words) {
+        new_term_ids[term_id] = term_word_offsets.size() - 1;
+        words_data += word;
+        term_word_offsets.push_back(words_data.size());
+
+        postings.clear();
+        term_to_document_freqs_[term_id].ForEach([&](int ordinal, double term_freq) {
+            postings.emplace_back(new_ordinals[ordinal], term_freq);
         });
-    return matched_documents;
-}
\ No newline at end of file
+        std::sort(postings.begin(), postings.end());
+        for (const auto& [ordinal, term_freq] : postings) {
+            posting_ordinals.push_back(ordinal);
+            posting_term_freqs.push_back(term_freq);
+        }
+        term_posting_offsets.push_back(posting_ordinals.size());
+    }
+
+    std::vector<uint64_t> document_term_offsets{0};
+    std::vector<int32_t> document_terms;
+    for (const auto& [document_id, ordinal] : document_to_ordinal_) {
+        const size_t first = document_terms.size();
+        for (const int term_id : document_terms_[ordinal])
+            document_terms.push_back(new_term_ids[term_id]);
+        std::sort(document_terms.begin() + first, document_terms.end());
+        document_term_offsets.push_back(document_terms.size());
+    }
+
+    std::string stop_words;
+    for (const std::string& word : stop_words_) {
+        if (!stop_words.empty())
+            stop_words.push_back(' ');
+        stop_words += word;
+    }
+
+    IndexFileHeader header{};
+    std::copy(std::begin(INDEX_FILE_MAGIC), std::end(INDEX_FILE_MAGIC), header.magic);
+    header.version = INDEX_FILE_VERSION;
+    header.header_size = sizeof(IndexFileHeader);
+    header.document_count = document_ids.size();
+    header.term_count = words.size();
+    header.posting_count = posting_ordinals.size();
+    header.stop_words_size = stop_words.size();
+    header.words_size = words_data.size();
+
+    const std::string temporary_path = path + ".tmp";
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("cannot write index file --> " + temporary_path);
+
+    // The header is written again once the checksum is known
+    uint64_t checksum = ComputeIndexFileChecksum(nullptr, 0);
+    uint64_t header_checksum = 0;
+    WriteIndexFileSection(out, &header, sizeof(header), header_checksum);
+    WriteIndexFileSection(out, stop_words.data(), stop_words.size(), checksum);
+    WriteIndexFileSection(out, term_word_offsets, checksum);
+    WriteIndexFileSection(out, words_data.data(), words_data.size(), checksum);
+    WriteIndexFileSection(out, term_posting_offsets, checksum);
+    WriteIndexFileSection(out, posting_ordinals, checksum);
+    WriteIndexFileSection(out, posting_term_freqs, checksum);
+    WriteIndexFileSection(out, document_ids, checksum);
+    WriteIndexFileSection(out, document_statuses, checksum);
+    WriteIndexFileSection(out, document_ratings, checksum);
+    WriteIndexFileSection(out, document_term_offsets, checksum);
+    WriteIndexFileSection(out, document_terms, checksum);
+
+    header.checksum = checksum;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("cannot write index file --> " + path);
+}
@@ -1,17 +1,29 @@
 #pragma once
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <execution>
+#include <fstream>
 #include <functional>
 #include <map>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
-#include "concurrent_map.h"
 #include "document.h"
+#include "document_id_iterator.h"
+#include "index_file.h"
+#include "memory_pool.h"
+#include "posting_list.h"
+#include "relevance_accumulator.h"
 #include "string_processing.h"
+#include "term_dictionary.h"
+#include "top_documents.h"
 
 const int MAX_RESULT_DOCUMENT_COUNT = 5;
 
@@ -19,13 +31,24 @@ class SearchServer {
 public:
     SearchServer() = default;
 
+    // A copy allocates its containers from a memory pool of its own
+    SearchServer(const SearchServer& other);
+
+    SearchServer(SearchServer&& other);
+
+    // An assigned server keeps its memory pool, so containers of another
+    // pool are copied into it
+    SearchServer& operator=(const SearchServer& other);
+
+    SearchServer& operator=(SearchServer&& other);
+
     explicit SearchServer(const std::string& stop_words_text)
-        : SearchServer(SplitIntoWords(stop_words_text))
+        : SearchServer(SplitIntoWordsView(stop_words_text))
     {
     }
 
     explicit SearchServer(const std::string_view& stop_words_text)
-        : SearchServer(SplitIntoWords(stop_words_text))
+        : SearchServer(SplitIntoWordsView(stop_words_text))
     {
     }
 
@@ -35,20 +58,33 @@ public:
     {
     }
 
-    inline auto begin() const noexcept {
-        return documents_ids_.begin();
+    // Ids of documents in order of addition
+    inline DocumentIdIterator begin() const {
+        return {ordinal_to_document_.begin(), ordinal_to_document_.end()};
     }
 
-    inline auto end() const noexcept {
-        return documents_ids_.end();
+    inline DocumentIdIterator end() const {
+        return {ordinal_to_document_.end(), ordinal_to_document_.end()};
     }
 
     inline int GetDocumentCount() const noexcept {
-        return documents_.size();
+        return document_to_ordinal_.size();
     }
 
     const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
 
+    // Number of documents containing the word
+    int GetDocumentFreq(std::string_view word) const;
+
+    // Sorted ids of the distinct words of a document, equal for documents
+    // with the same set of words
+    const std::pmr::vector<int>& GetDocumentTerms(int document_id) const;
+
+    // Writes the index to a binary file of the index_file.h format, which
+    // MappedSearchServer::Open serves queries from. The file is replaced
+    // only once it is written completely.
+    void Save(const std::string& path) const;
+
     void AddDocument(
         int document_id,
         const std::string_view& text,
@@ -56,8 +92,16 @@ public:
         const std::vector<int>& ratings
     );
 
+    inline void AddDocuments(const std::vector<RawDocument>& documents) {
+        AddDocuments(std::execution::seq, documents);
+    }
+
+    template <typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy execution_policy,
+                      const std::vector<RawDocument>& documents);
+
     inline std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
-        const std::string& raw_query,
+        const std::string_view& raw_query,
         int document_id
     ) const
     {
@@ -72,12 +116,24 @@ public:
 
     void RemoveDocument(std::execution::parallel_policy, int document_id);
 
+    // Removes a batch of documents with a single update of the index:
+    // postings are erased term by term. Unknown ids are ignored.
+    inline void RemoveDocuments(const std::vector<int>& document_ids) {
+        RemoveDocuments(std::execution::seq, document_ids);
+    }
+
+    template <typename ExecutionPolicy>
+    void RemoveDocuments(ExecutionPolicy execution_policy,
+                         const std::vector<int>& document_ids);
+
     inline std::vector<Document> FindTopDocuments(
         const std::string_view& raw_query,
-        DocumentStatus status_to_find = DocumentStatus::ACTUAL
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
     ) const
     {
-        return FindTopDocuments(std::execution::seq, raw_query, status_to_find);
+        return FindTopDocuments(std::execution::seq, raw_query, status_to_find,
+                                max_document_count);
     }
 
     template <typename ExecutionPolicy>
@@ -87,162 +143,455 @@ public:
         int document_id
     ) const;
 
+    // Overloads filling matched_words, whose capacity is reused between calls
+    inline DocumentStatus MatchDocument(
+        const std::string_view& raw_query,
+        int document_id,
+        std::vector<std::string_view>& matched_words
+    ) const
+    {
+        return MatchDocument(std::execution::seq, raw_query, document_id, matched_words);
+    }
+
+    DocumentStatus MatchDocument(
+        std::execution::sequenced_policy,
+        const std::string_view& raw_query,
+        int document_id,
+        std::vector<std::string_view>& matched_words
+    ) const;
+
+    template <typename ExecutionPolicy>
+    DocumentStatus MatchDocument(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        int document_id,
+        std::vector<std::string_view>& matched_words
+    ) const;
+
     template <typename ExecutionPolicy>
     inline std::vector<Document> FindTopDocuments(
         ExecutionPolicy execution_policy,
         const std::string_view& raw_query,
-        DocumentStatus status_to_find = DocumentStatus::ACTUAL
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
     ) const;
 
     template <typename DocumentPredicate>
     inline std::vector<Document> FindTopDocuments(
         const std::string_view& raw_query,
-        DocumentPredicate doc_predicate
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
     ) const;
 
     template <typename DocumentPredicate, typename ExecutionPolicy>
     std::vector<Document> FindTopDocuments(
         ExecutionPolicy execution_policy,
         const std::string_view& raw_query,
-        DocumentPredicate doc_predicate
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
     ) const;
 
 private:
-    struct DocumentData {
-        DocumentData() = default;
-        explicit DocumentData(const std::vector<std::string>& words,
-                              DocumentStatus status,
-                              const std::vector<int>& ratings)
-            : unique_words({words.begin(), words.end()})
-            , status(status)
-            , rating(ComputeAverageRating(ratings))
-        {
-        }
-
-        std::set<std::string> unique_words;
+    // Shards and segments share corpus-wide inverse document frequencies
+    friend class ShardedSearchServer;
+    friend class IndexSnapshot;
+    // Mapped indexes parse queries by a server of their stop words
+    friend class MappedSearchServer;
+    // Loaders tokenize and index batches on different threads
+    friend class DocumentLoader;
+    // Cached results are keyed by the parsed query and the generation
+    friend class QueryResultCache;
+
+    // Words are views of the document text, which is copied only when
+    // the term dictionary meets a new word
+    struct TokenizedDocument {
+        std::vector<std::string_view> words;
+        // Distinct words ordered by word
+        std::vector<std::pair<std::string_view, double>> word_freqs;
         DocumentStatus status;
         int rating;
+        bool is_valid;
     };
     struct QueryWord {
         std::string_view data;
         bool is_minus;
         bool is_stop;
     };
+    // Words of both lists are sorted and unique
     struct Query {
-        std::set<std::string_view, std::less<>> plus_words;
-        std::set<std::string_view, std::less<>> minus_words;
+        std::vector<std::string_view> plus_words;
+        std::vector<std::string_view> minus_words;
+    };
+
+    struct WeightedPostings {
+        const PostingList* postings;
+        double inverse_document_freq;
+    };
+    struct QueryPostings {
+        std::vector<WeightedPostings> plus;
+        std::vector<const PostingList*> minus;
+    };
+
+    struct WordFrequencies {
+        uint64_t generation = 0;
+        std::map<std::string_view, double> word_to_freq;
     };
 
-    const std::set<std::string, std::less<>> stop_words_ = {};
-    std::map<std::string, std::map<int, double>, std::less<>> word_to_document_freqs_;
-    std::map<int, std::map<std::string_view, double>> document_to_word_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::vector<int> documents_ids_;
+    // Nodes of maps and small arrays allocated per document come from the
+    // pool, so building an index allocates large blocks only, and the pool
+    // releases them at once. Must be declared before the containers.
+    MemoryPool memory_;
+
+    std::set<std::string, std::less<>> stop_words_ = {};
+    TermDictionary terms_;
+    std::vector<PostingList> term_to_document_freqs_;
+
+    // Documents are numbered by dense ordinals in order of addition, which
+    // postings and the document table refer to. A removed document leaves
+    // a hole (-1 id) until the ordinals are renumbered by CompactDocuments(),
+    // so ordinal_to_document_ also serves the iteration over documents
+    std::pmr::map<int, int> document_to_ordinal_{memory_.get()};
+    std::vector<int> ordinal_to_document_;
+    std::vector<DocumentStatus> statuses_;
+    std::vector<int> ratings_;
+    std::pmr::vector<std::pmr::vector<int>> document_terms_{memory_.get()};
+
+    // Number of ordinals scored by one task of a parallel query
+    const static int ordinal_chunk_size_ = 1 << 16;
+
+    // Query words are sorted in parallel starting from this number only
+    const static size_t parallel_sort_size_ = 1 << 10;
+
+    // Postings of a removed document are erased in parallel starting from
+    // this number of its words only
+    const static size_t parallel_erase_size_ = 1 << 8;
+
+    // Bumped by every corpus change, so the inverse document frequencies
+    // cached in document_to_word_freqs_ are recomputed lazily per document
+    // instead of for the whole corpus on each AddDocument/RemoveDocument,
+    // and a QueryResultCache drops results of an older corpus
+    uint64_t generation_ = 0;
+    mutable std::map<int, WordFrequencies> document_to_word_freqs_;
+    // Const readers may fill the cache concurrently. Entries are only
+    // rebuilt after a corpus change, which never runs along with readers
+    mutable std::mutex word_freqs_mutex_;
 
     static bool IsValidWord(const std::string_view& word);
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
 
-    static Query ThrowInvalidQuery(const Query& query);
+    static bool IsValidWords(const std::vector<std::string_view>& words);
+
+    void ThrowInvalidDocumentId(int document_id) const;
+
+    // Throws for an id used by the server or repeated in the batch
+    void ThrowInvalidDocumentIds(const std::vector<RawDocument>& documents) const;
+
+    int AppendDocument(int document_id, DocumentStatus status, int rating);
+
+    // Drops caches of the corpus replaced by an assignment
+    void OnAssigned(uint64_t other_generation);
+
+    PostingList& GetTermPostings(int term_id);
+
+    // Appends documents of other index for which is_kept(document_id) holds,
+    // copying their term frequencies instead of tokenizing texts again
+    template <typename DocumentPredicate>
+    void MergeDocuments(const SearchServer& other, DocumentPredicate is_kept);
+
+    // Erases a document from the document table, but not from postings
+    void EraseDocument(int document_id, int ordinal);
+
+    // Removes the word of a term which is left without postings
+    void ReleaseTermIfUnused(int term_id);
+
+    // Renumbers ordinals once holes make up half of the document table
+    void CompactDocuments();
+
+    static void ThrowInvalidQuery(const Query& query);
 
     inline bool IsStopWord(const std::string_view& word) const {
         return stop_words_.count(word);
     }
 
-    inline bool IsContainWord(const std::string_view& word) const {
-        return word_to_document_freqs_.count(word);
+    inline bool IsDocumentContainWord(int ordinal,
+                                      const std::string_view& word) const {
+        const int term_id = terms_.Find(word);
+        return term_id != TermDictionary::NOT_FOUND
+            && std::binary_search(document_terms_[ordinal].begin(),
+                                  document_terms_[ordinal].end(),
+                                  term_id);
     }
 
-    inline bool IsWordContainId(const std::string& word,
-                                const int& document_id) const {
-        return word_to_document_freqs_.at({word.begin(), word.end()}).count(document_id);
-    }
+    std::vector<std::string_view> SplitIntoWordsNoStop(const std::string_view& text) const;
+
+    TokenizedDocument TokenizeDocument(const RawDocument& document) const;
+
+    // Tokenizes a batch, throwing for the first document of invalid words.
+    // Reads only stop words, so it may run while another thread changes
+    // the index.
+    template <typename ExecutionPolicy>
+    std::vector<TokenizedDocument> TokenizeDocuments(
+        ExecutionPolicy execution_policy,
+        const std::vector<RawDocument>& documents
+    ) const;
 
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string_view& text) const;
+    // Adds a tokenized batch, whose ids must have been checked
+    void IndexDocuments(const std::vector<RawDocument>& documents,
+                        const std::vector<TokenizedDocument>& tokenized_documents);
 
     QueryWord ParseQueryWord(std::string_view word) const;
 
-    double ComputeWordInverseDocumentFreq(const std::string& word) const;
+    double ComputeTermInverseDocumentFreq(int term_id) const;
 
     inline Query ParseQuery(const std::string_view& text) const {
         return ParseQuery(std::execution::seq, text);
     }
 
-    inline void UpdateInverseDocumentFreqs() {
-        UpdateInverseDocumentFreqs(std::execution::seq);
-    }
+    static void AddQueryWord(const QueryWord& query_word, Query& query);
 
-    std::vector<Document> ConvertToMatchedDocuments(
-        std::map<int, double> document_to_relevance
+    DocumentStatus MatchQuery(const Query& query,
+                              int document_id,
+                              std::vector<std::string_view>& matched_words) const;
+
+    QueryPostings FindQueryPostings(const Query& query) const;
+
+    // Postings weighted by the given inverse document frequencies
+    // of the plus words of the query
+    QueryPostings FindQueryPostings(
+        const Query& query,
+        const std::vector<double>& inverse_document_freqs
     ) const;
 
     template<typename ExecutionPolicy>
     Query ParseQuery(ExecutionPolicy execution_policy,
                      const std::string_view& text) const;
 
+    // Parses into query reusing the capacity of its vectors
+    template<typename ExecutionPolicy>
+    void ParseQuery(ExecutionPolicy execution_policy,
+                    const std::string_view& text,
+                    Query& query) const;
+
+    template<typename ExecutionPolicy>
+    static void SortUniqueWords(ExecutionPolicy execution_policy,
+                                std::vector<std::string_view>& words);
+
     template <typename StringContainer>
-    static StringContainer ThrowInvalidWords(const StringContainer& words);
+    static const StringContainer& ThrowInvalidWords(const StringContainer& words);
 
     template <typename StringContainer, typename WordPredicate>
-    static StringContainer ThrowInvalidWords(const StringContainer& words,
-                                             WordPredicate word_predicate);
-
-    template<typename ExecutionPolicy>
-    void UpdateInverseDocumentFreqs(ExecutionPolicy execution_policy);
+    static const StringContainer& ThrowInvalidWords(const StringContainer& words,
+                                                    WordPredicate word_predicate);
 
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(std::execution::sequenced_policy,
                                            const Query& query,
-                                           DocumentPredicate predicate) const;
+                                           DocumentPredicate predicate,
+                                           size_t max_document_count) const;
 
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(std::execution::parallel_policy,
                                            const Query& query,
-                                           DocumentPredicate predicate) const;
+                                           DocumentPredicate predicate,
+                                           size_t max_document_count) const;
 
-    template <typename ExecutionPolicy, typename DocumentPredicate, typename Container>
-    void FindAllDocuments(ExecutionPolicy execution_policy,
-                          const Query& query,
-                          DocumentPredicate predicate,
-                          Container& document_to_relevance) const;
+    template <typename DocumentPredicate>
+    TopDocuments FindDocumentsInRange(const QueryPostings& query_postings,
+                                      DocumentPredicate predicate,
+                                      int first_ordinal,
+                                      int last_ordinal,
+                                      size_t max_document_count) const;
 };
 
-template<typename ExecutionPolicy>
-std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
+template <typename ExecutionPolicy>
+void SearchServer::AddDocuments(ExecutionPolicy execution_policy,
+                                const std::vector<RawDocument>& documents)
+{
+    ThrowInvalidDocumentIds(documents);
+    IndexDocuments(documents, TokenizeDocuments(execution_policy, documents));
+}
+
+template <typename ExecutionPolicy>
+std::vector<SearchServer::TokenizedDocument> SearchServer::TokenizeDocuments(
     ExecutionPolicy execution_policy,
-    const std::string_view& raw_query,
-    int document_id
+    const std::vector<RawDocument>& documents
 ) const
 {
-    const Query query = ThrowInvalidQuery(
-        ParseQuery(execution_policy, raw_query)
+    // Exceptions must not escape a parallel algorithm, so invalid words are
+    // searched for in parallel and thrown from the calling thread
+    std::vector<TokenizedDocument> tokenized_documents(documents.size());
+    std::transform(
+        execution_policy,
+        documents.begin(), documents.end(),
+        tokenized_documents.begin(),
+        [this](const RawDocument& document) {
+            return TokenizeDocument(document);
+        }
     );
+    const auto invalid_document = std::find_if(
+        execution_policy,
+        tokenized_documents.begin(), tokenized_documents.end(),
+        [](const TokenizedDocument& document) {
+            return !document.is_valid;
+        }
+    );
+    if (invalid_document != tokenized_documents.end())
+        ThrowInvalidWords(invalid_document->words);
 
-    std::vector<std::string_view> matched_words;
-    for (const std::string_view& word : query.plus_words) {
-        if (!IsContainWord(word))
+    return tokenized_documents;
+}
+
+template <typename DocumentPredicate>
+void SearchServer::MergeDocuments(const SearchServer& other,
+                                  DocumentPredicate is_kept)
+{
+    std::vector<int> new_ordinals(other.ordinal_to_document_.size(), -1);
+    const size_t first_ordinal = ordinal_to_document_.size();
+    for (size_t ordinal = 0; ordinal < other.ordinal_to_document_.size(); ++ordinal) {
+        const int document_id = other.ordinal_to_document_[ordinal];
+        if (document_id < 0 || !is_kept(document_id))
             continue;
 
-        if (IsWordContainId({word.begin(), word.end()}, document_id))
-            matched_words.push_back(word);
+        ThrowInvalidDocumentId(document_id);
+        new_ordinals[ordinal] = AppendDocument(document_id,
+                                               other.statuses_[ordinal],
+                                               other.ratings_[ordinal]);
     }
-    for (const std::string_view& word : query.minus_words) {
-        if (!IsContainWord(word))
+
+    // Kept documents are appended in order, so postings are appended too
+    for (size_t term_id = 0; term_id < other.term_to_document_freqs_.size(); ++term_id) {
+        int new_term_id = TermDictionary::NOT_FOUND;
+        other.term_to_document_freqs_[term_id].ForEach(
+            [&](int ordinal, double term_freq) {
+                const int new_ordinal = new_ordinals[ordinal];
+                if (new_ordinal < 0)
+                    return;
+                if (new_term_id == TermDictionary::NOT_FOUND)
+                    new_term_id = terms_.Add(other.terms_.GetWord(term_id));
+                GetTermPostings(new_term_id).Add(new_ordinal, term_freq);
+                document_terms_[new_ordinal].push_back(new_term_id);
+            }
+        );
+    }
+    for (size_t ordinal = first_ordinal; ordinal < document_terms_.size(); ++ordinal)
+        std::sort(document_terms_[ordinal].begin(), document_terms_[ordinal].end());
+
+    ++generation_;
+}
+
+template <typename ExecutionPolicy>
+void SearchServer::RemoveDocuments(ExecutionPolicy execution_policy,
+                                   const std::vector<int>& document_ids)
+{
+    // (term id, ordinal) of every posting of the removed documents
+    std::vector<std::pair<int, int>> postings;
+    bool is_removed = false;
+    for (const int document_id : document_ids) {
+        const auto it = document_to_ordinal_.find(document_id);
+        if (it == document_to_ordinal_.end())
             continue;
 
-        if (IsWordContainId({word.begin(), word.end()}, document_id)) {
-            matched_words.clear();
-            break;
+        const int ordinal = it->second;
+        for (const int term_id : document_terms_[ordinal])
+            postings.emplace_back(term_id, ordinal);
+        EraseDocument(document_id, ordinal);
+        is_removed = true;
+    }
+    if (!is_removed)
+        return;
+
+    std::sort(execution_policy, postings.begin(), postings.end());
+    std::vector<int> ordinals(postings.size());
+    std::transform(
+        execution_policy,
+        postings.begin(), postings.end(),
+        ordinals.begin(),
+        [](const std::pair<int, int>& posting) { return posting.second; }
+    );
+
+    // Every term owns a run of sorted ordinals and a posting list of its own,
+    // so the runs are erased independently of each other
+    // [first, last) positions of the run of every term
+    std::vector<std::pair<size_t, size_t>> term_runs;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (i == 0 || postings[i].first != postings[i - 1].first) {
+            if (!term_runs.empty())
+                term_runs.back().second = i;
+            term_runs.emplace_back(i, postings.size());
         }
     }
-    return {matched_words, documents_.at(document_id).status};
+
+    std::for_each(
+        execution_policy,
+        term_runs.begin(), term_runs.end(),
+        [this, &postings, &ordinals](const std::pair<size_t, size_t>& run) {
+            term_to_document_freqs_[postings[run.first].first].Erase(
+                ordinals.begin() + run.first, ordinals.begin() + run.second
+            );
+        }
+    );
+    for (const std::pair<size_t, size_t>& run : term_runs)
+        ReleaseTermIfUnused(postings[run.first].first);
+
+    CompactDocuments();
+
+    ++generation_;
+}
+
+template<typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    int document_id
+) const
+{
+    std::vector<std::string_view> matched_words;
+    const DocumentStatus status = MatchDocument(execution_policy, raw_query,
+                                                document_id, matched_words);
+    return {std::move(matched_words), status};
+}
+
+template<typename ExecutionPolicy>
+DocumentStatus SearchServer::MatchDocument(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    int document_id,
+    std::vector<std::string_view>& matched_words
+) const
+{
+    const Query query = ParseQuery(execution_policy, raw_query);
+    ThrowInvalidQuery(query);
+
+    const int ordinal = document_to_ordinal_.at(document_id);
+    const auto is_contained = [this, ordinal](const std::string_view& word) {
+        return IsDocumentContainWord(ordinal, word);
+    };
+
+    matched_words.clear();
+    if (std::any_of(execution_policy,
+                    query.minus_words.begin(), query.minus_words.end(),
+                    is_contained))
+        return statuses_[ordinal];
+
+    // copy_if keeps the order of the plus words, which are already unique
+    matched_words.resize(query.plus_words.size());
+    const auto matched_end = std::copy_if(
+        execution_policy,
+        query.plus_words.begin(), query.plus_words.end(),
+        matched_words.begin(),
+        is_contained
+    );
+    matched_words.erase(matched_end, matched_words.end());
+    return statuses_[ordinal];
 }
 
 template <typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(
     ExecutionPolicy execution_policy,
     const std::string_view& raw_query,
-    DocumentStatus status_to_find
+    DocumentStatus status_to_find,
+    size_t max_document_count
 ) const
 {
     return FindTopDocuments(
@@ -251,41 +600,34 @@ std::vector<Document> SearchServer::FindTopDocuments(
         [status_to_find](__attribute__((unused)) int document_id,
                         DocumentStatus status,
                         __attribute__((unused)) int rating)
-        { return status == status_to_find; }
+        { return status == status_to_find; },
+        max_document_count
     );
 }
 
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindTopDocuments(
     const std::string_view& raw_query,
-    DocumentPredicate doc_predicate
+    DocumentPredicate doc_predicate,
+    size_t max_document_count
 ) const
 {
-    return FindTopDocuments(std::execution::seq, raw_query, doc_predicate);
+    return FindTopDocuments(std::execution::seq, raw_query, doc_predicate,
+                            max_document_count);
 }
 
 template <typename DocumentPredicate, typename ExecutionPolicy>
 std::vector<Document> SearchServer::FindTopDocuments(
     ExecutionPolicy execution_policy,
     const std::string_view& raw_query,
-    DocumentPredicate doc_predicate
+    DocumentPredicate doc_predicate,
+    size_t max_document_count
 ) const
 {
-    const Query query = ThrowInvalidQuery(ParseQuery(raw_query));
-    auto matched_documents = FindAllDocuments(execution_policy, query, doc_predicate);
-
-    sort(
-        matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-        return (std::abs(lhs.relevance - rhs.relevance) < 1e-6)
-                ? lhs.rating > rhs.rating
-                : lhs.relevance > rhs.relevance;
-        }
-    );
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT)
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
-
-    return matched_documents;
+    const Query query = ParseQuery(execution_policy, raw_query);
+    ThrowInvalidQuery(query);
+    return FindAllDocuments(execution_policy, query, doc_predicate,
+                            max_document_count);
 }
 
 template<typename ExecutionPolicy>
@@ -295,23 +637,57 @@ SearchServer::Query SearchServer::ParseQuery(
 ) const
 {
     Query query;
-    const std::vector<std::string_view> words = SplitIntoWordsView(text);
-    std::for_each(
-        execution_policy,
-        words.begin(), words.end(),
-        [&](const auto& word) {
-            const QueryWord query_word = ParseQueryWord(word);
-            if (!query_word.is_stop && query_word.is_minus)
-                query.minus_words.insert(query_word.data);
-            else if (!query_word.is_stop)
-                query.plus_words.insert(query_word.data);
-        }
-    );
+    ParseQuery(execution_policy, text, query);
     return query;
 }
 
+template<typename ExecutionPolicy>
+void SearchServer::ParseQuery(
+    ExecutionPolicy execution_policy,
+    const std::string_view& text,
+    Query& query
+) const
+{
+    query.plus_words.clear();
+    query.minus_words.clear();
+
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>,
+                                 std::execution::sequenced_policy>) {
+        ForEachWord(text, [this, &query](std::string_view word) {
+            AddQueryWord(ParseQueryWord(word), query);
+        });
+    } else {
+        const std::vector<std::string_view> words = SplitIntoWordsView(text);
+        std::vector<QueryWord> query_words(words.size());
+        std::transform(
+            execution_policy,
+            words.begin(), words.end(),
+            query_words.begin(),
+            [this](const std::string_view& word) {
+                return ParseQueryWord(word);
+            }
+        );
+        for (const QueryWord& query_word : query_words)
+            AddQueryWord(query_word, query);
+    }
+
+    SortUniqueWords(execution_policy, query.plus_words);
+    SortUniqueWords(execution_policy, query.minus_words);
+}
+
+template<typename ExecutionPolicy>
+void SearchServer::SortUniqueWords(ExecutionPolicy execution_policy,
+                                   std::vector<std::string_view>& words) {
+    if (words.size() < parallel_sort_size_)
+        std::sort(words.begin(), words.end());
+    else
+        std::sort(execution_policy, words.begin(), words.end());
+
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
 template <typename StringContainer>
-StringContainer SearchServer::ThrowInvalidWords(const StringContainer& words) {
+const StringContainer& SearchServer::ThrowInvalidWords(const StringContainer& words) {
     return ThrowInvalidWords(
         words,
         [](const auto& word){ return !IsValidWord(word); }
@@ -319,89 +695,111 @@ StringContainer SearchServer::ThrowInvalidWords(const StringContainer& words) {
 }
 
 template <typename StringContainer, typename WordPredicate>
-StringContainer SearchServer::ThrowInvalidWords(const StringContainer& words,
-                                                WordPredicate word_predicate) {
+const StringContainer& SearchServer::ThrowInvalidWords(const StringContainer& words,
+                                                       WordPredicate word_predicate) {
     for (const auto& word : words) {
-        const std::string word_s{word.begin(), word.end()};
-        if (word_predicate(word_s))
-            throw std::invalid_argument("invalid word --> [" + word_s + ']');
+        if (word_predicate(std::string_view(word)))
+            throw std::invalid_argument(
+                "invalid word --> [" + std::string(word.begin(), word.end()) + ']'
+            );
     }
     return words;
 }
 
-template<typename ExecutionPolicy>
-void SearchServer::UpdateInverseDocumentFreqs(ExecutionPolicy execution_policy) {
-    std::for_each(
-        execution_policy,
-        documents_ids_.begin(),
-        documents_ids_.end(),
-        [&](const int documents_id){
-            for (const std::string& word : documents_.at(documents_id).unique_words)
-                document_to_word_freqs_[documents_id][word] = ComputeWordInverseDocumentFreq(word);
-        }
-    );
-}
-
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(
     std::execution::sequenced_policy,
     const Query& query,
-    DocumentPredicate predicate
+    DocumentPredicate predicate,
+    size_t max_document_count
 ) const
 {
-    std::map<int, double> document_to_relevance;
-    FindAllDocuments(std::execution::seq, query, predicate, document_to_relevance);
-    return ConvertToMatchedDocuments(document_to_relevance);
+    return FindDocumentsInRange(
+        FindQueryPostings(query),
+        predicate,
+        0, ordinal_to_document_.size(),
+        max_document_count
+    ).Build();
 }
 
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(
     std::execution::parallel_policy,
     const Query& query,
-    DocumentPredicate predicate
+    DocumentPredicate predicate,
+    size_t max_document_count
 ) const
 {
-    ConcurrentMap<int, double> document_to_relevance;
-    FindAllDocuments(std::execution::par, query, predicate, document_to_relevance);
-    return ConvertToMatchedDocuments(document_to_relevance.BuildOrdinaryMap());
+    const QueryPostings query_postings = FindQueryPostings(query);
+
+    // Every task scores its own chunk of ordinals and selects the top
+    // documents of it, which are merged afterwards
+    std::vector<int> first_ordinals;
+    for (size_t ordinal = 0; ordinal < ordinal_to_document_.size(); ordinal += ordinal_chunk_size_)
+        first_ordinals.push_back(ordinal);
+
+    return std::transform_reduce(
+        std::execution::par,
+        first_ordinals.begin(), first_ordinals.end(),
+        TopDocuments(max_document_count),
+        [](TopDocuments lhs, const TopDocuments& rhs) {
+            lhs.Merge(rhs);
+            return lhs;
+        },
+        [&](int first_ordinal) {
+            const int last_ordinal = std::min<size_t>(first_ordinal + ordinal_chunk_size_,
+                                                      ordinal_to_document_.size());
+            return FindDocumentsInRange(query_postings, predicate,
+                                        first_ordinal, last_ordinal,
+                                        max_document_count);
+        }
+    ).Build();
 }
 
-template <typename ExecutionPolicy, typename DocumentPredicate, typename Container>
-void SearchServer::FindAllDocuments(
-    ExecutionPolicy execution_policy,
-    const Query& query,
+template <typename DocumentPredicate>
+TopDocuments SearchServer::FindDocumentsInRange(
+    const QueryPostings& query_postings,
     DocumentPredicate predicate,
-    Container& document_to_relevance
+    int first_ordinal,
+    int last_ordinal,
+    size_t max_document_count
 ) const
 {
-    std::for_each(
-        execution_policy,
-        query.plus_words.begin(),
-        query.plus_words.end(),
-        [this, &document_to_relevance, predicate](const std::string_view& word) {
-            if (word_to_document_freqs_.count(word)) {
-                const std::string word_s{word.begin(), word.end()};
-
-                const double inverse_document_freq = ComputeWordInverseDocumentFreq(word_s);
-                for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word_s))
-                    if (predicate(document_id,
-                                  documents_.at(document_id).status,
-                                  documents_.at(document_id).rating)
-                    ) document_to_relevance[document_id] += term_freq*inverse_document_freq;
-            }
-        }
-    );
+    RelevanceAccumulator& accumulator = RelevanceAccumulator::Get(last_ordinal - first_ordinal);
 
-    std::for_each(
-        execution_policy,
-        query.minus_words.begin(),
-        query.minus_words.end(),
-        [this, &document_to_relevance, predicate](const std::string_view& word) {
-            if (word_to_document_freqs_.count(word)) {
-                const std::string word_s{word.begin(), word.end()};
-                for (const auto& [document_id, _] : word_to_document_freqs_.at(word_s))
-                    document_to_relevance.erase(document_id);
+    for (const PostingList* postings : query_postings.minus)
+        postings->ForEach(
+            first_ordinal, last_ordinal,
+            [&](int ordinal, double) {
+                accumulator.Exclude(ordinal - first_ordinal);
             }
-        }
-    );
-}
\ No newline at end of file
+        );
+
+    // A document predicate is checked once, on the first matching word
+    for (const auto& [postings, inverse_document_freq] : query_postings.plus)
+        postings->ForEach(
+            first_ordinal, last_ordinal,
+            [&, inverse_document_freq = inverse_document_freq](int ordinal, double term_freq) {
+                const size_t i = ordinal - first_ordinal;
+                if (accumulator.IsUntouched(i)) {
+                    if (predicate(ordinal_to_document_[ordinal],
+                                  statuses_[ordinal],
+                                  ratings_[ordinal]))
+                        accumulator.Match(i);
+                    else
+                        accumulator.Exclude(i);
+                }
+                if (accumulator.IsMatched(i))
+                    accumulator.Add(i, term_freq*inverse_document_freq);
+            }
+        );
+
+    TopDocuments top_documents(max_document_count);
+    for (const uint32_t i : accumulator.GetMatched())
+        top_documents.Add({
+            ordinal_to_document_[first_ordinal + i],
+            accumulator.GetRelevance(i),
+            ratings_[first_ordinal + i]
+        });
+    return top_documents;
+}
@@ -0,0 +1,61 @@
+#include "sharded_search_server.h"
+
+int ShardedSearchServer::GetDocumentCount() const {
+    int document_count = 0;
+    for (const SearchServer& shard : shards_)
+        document_count += shard.GetDocumentCount();
+    return document_count;
+}
+
+void ShardedSearchServer::AddDocument(
+    int document_id,
+    const std::string_view& text,
+    DocumentStatus status,
+    const std::vector<int>& ratings
+)
+{
+    GetShard(document_id).AddDocument(document_id, text, status, ratings);
+}
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    GetShard(document_id).RemoveDocument(document_id);
+}
+
+std::vector<double> ShardedSearchServer::ComputeInverseDocumentFreqs(
+    const SearchServer::Query& query
+) const
+{
+    const int document_count = GetDocumentCount();
+
+    std::vector<double> inverse_document_freqs;
+    inverse_document_freqs.reserve(query.plus_words.size());
+    for (const std::string_view& word : query.plus_words) {
+        int document_freq = 0;
+        for (const SearchServer& shard : shards_)
+            document_freq += shard.GetDocumentFreq(word);
+
+        inverse_document_freqs.push_back(
+            document_freq
+                ? log(static_cast<double>(document_count)/document_freq)
+                : 0
+        );
+    }
+    return inverse_document_freqs;
+}
+
+void ShardedSearchServer::ThrowInvalidDocuments(
+    const std::vector<RawDocument>& documents
+) const
+{
+    std::set<int> batch_ids;
+    for (const RawDocument& document : documents) {
+        GetShard(document.id).ThrowInvalidDocumentId(document.id);
+        if (!batch_ids.insert(document.id).second)
+            throw std::invalid_argument(
+                "already used id --> " + std::to_string(document.id)
+            );
+        // Stop words are valid, so checking all words is the same
+        // as checking the words left after stop words
+        SearchServer::ThrowInvalidWords(SplitIntoWordsView(document.text));
+    }
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include <algorithm>
+#include <execution>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+#include "top_documents.h"
+
+// Search server splitting documents among shards by document id. Shards
+// share corpus-wide statistics, so the relevance of a document is the same
+// as in a single SearchServer of all documents, while queries and batches
+// of documents are processed by the shards in parallel
+class ShardedSearchServer {
+public:
+    explicit ShardedSearchServer(
+        size_t shard_count = std::max(1u, std::thread::hardware_concurrency())
+    )
+        : ShardedSearchServer(shard_count, std::vector<std::string>{})
+    {
+    }
+
+    template <typename StopWords>
+    ShardedSearchServer(size_t shard_count, const StopWords& stop_words);
+
+    inline size_t GetShardCount() const noexcept {
+        return shards_.size();
+    }
+
+    int GetDocumentCount() const;
+
+    void AddDocument(
+        int document_id,
+        const std::string_view& text,
+        DocumentStatus status,
+        const std::vector<int>& ratings
+    );
+
+    inline void AddDocuments(const std::vector<RawDocument>& documents) {
+        AddDocuments(std::execution::seq, documents);
+    }
+
+    template <typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy execution_policy,
+                      const std::vector<RawDocument>& documents);
+
+    void RemoveDocument(int document_id);
+
+    template <typename ExecutionPolicy>
+    void RemoveDocument(ExecutionPolicy execution_policy, int document_id);
+
+    inline void RemoveDocuments(const std::vector<int>& document_ids) {
+        RemoveDocuments(std::execution::seq, document_ids);
+    }
+
+    template <typename ExecutionPolicy>
+    void RemoveDocuments(ExecutionPolicy execution_policy,
+                         const std::vector<int>& document_ids);
+
+    inline std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::string_view& raw_query,
+        int document_id
+    ) const
+    {
+        return GetShard(document_id).MatchDocument(raw_query, document_id);
+    }
+
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        int document_id
+    ) const
+    {
+        return GetShard(document_id).MatchDocument(execution_policy, raw_query,
+                                                   document_id);
+    }
+
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return FindTopDocuments(std::execution::seq, raw_query, status_to_find,
+                                max_document_count);
+    }
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+    template <typename DocumentPredicate>
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return FindTopDocuments(std::execution::seq, raw_query, doc_predicate,
+                                max_document_count);
+    }
+
+    // Every shard selects its top documents, which are merged afterwards
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const;
+
+private:
+    std::vector<SearchServer> shards_;
+
+    inline size_t GetShardIndex(int document_id) const {
+        return static_cast<unsigned>(document_id) % shards_.size();
+    }
+
+    inline const SearchServer& GetShard(int document_id) const {
+        return shards_[GetShardIndex(document_id)];
+    }
+
+    inline SearchServer& GetShard(int document_id) {
+        return shards_[GetShardIndex(document_id)];
+    }
+
+    // Inverse document frequencies of the plus words over all shards
+    std::vector<double> ComputeInverseDocumentFreqs(
+        const SearchServer::Query& query
+    ) const;
+
+    void ThrowInvalidDocuments(const std::vector<RawDocument>& documents) const;
+};
+
+
+/* ------------------------------- TEMPLATES ------------------------------- */
+
+template <typename StopWords>
+ShardedSearchServer::ShardedSearchServer(size_t shard_count,
+                                         const StopWords& stop_words)
+{
+    if (shard_count == 0)
+        throw std::invalid_argument("shard count must be positive");
+
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+        shards_.emplace_back(stop_words);
+}
+
+template <typename ExecutionPolicy>
+void ShardedSearchServer::AddDocuments(ExecutionPolicy execution_policy,
+                                       const std::vector<RawDocument>& documents)
+{
+    // An exception must not escape a parallel task, and a batch must not be
+    // added partially, so the whole batch is validated up front
+    ThrowInvalidDocuments(documents);
+
+    std::vector<std::vector<RawDocument>> shard_documents(shards_.size());
+    for (const RawDocument& document : documents)
+        shard_documents[GetShardIndex(document.id)].push_back(document);
+
+    std::for_each(
+        execution_policy,
+        shard_documents.begin(), shard_documents.end(),
+        [this, &shard_documents](const std::vector<RawDocument>& documents) {
+            if (!documents.empty())
+                shards_[&documents - shard_documents.data()].AddDocuments(
+                    std::execution::seq, documents
+                );
+        }
+    );
+}
+
+template <typename ExecutionPolicy>
+void ShardedSearchServer::RemoveDocument(ExecutionPolicy execution_policy,
+                                         int document_id) {
+    GetShard(document_id).RemoveDocument(execution_policy, document_id);
+}
+
+template <typename ExecutionPolicy>
+void ShardedSearchServer::RemoveDocuments(ExecutionPolicy execution_policy,
+                                          const std::vector<int>& document_ids)
+{
+    std::vector<std::vector<int>> shard_document_ids(shards_.size());
+    for (const int document_id : document_ids)
+        shard_document_ids[GetShardIndex(document_id)].push_back(document_id);
+
+    std::for_each(
+        execution_policy,
+        shard_document_ids.begin(), shard_document_ids.end(),
+        [this, &shard_document_ids](const std::vector<int>& document_ids) {
+            if (!document_ids.empty())
+                shards_[&document_ids - shard_document_ids.data()].RemoveDocuments(
+                    std::execution::seq, document_ids
+                );
+        }
+    );
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    DocumentStatus status_to_find,
+    size_t max_document_count
+) const
+{
+    return FindTopDocuments(
+        execution_policy,
+        raw_query,
+        [status_to_find](__attribute__((unused)) int document_id,
+                        DocumentStatus status,
+                        __attribute__((unused)) int rating)
+        { return status == status_to_find; },
+        max_document_count
+    );
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(
+    ExecutionPolicy execution_policy,
+    const std::string_view& raw_query,
+    DocumentPredicate doc_predicate,
+    size_t max_document_count
+) const
+{
+    // Shards share stop words, so any of them parses the query
+    const SearchServer::Query query = shards_.front().ParseQuery(execution_policy,
+                                                                 raw_query);
+    SearchServer::ThrowInvalidQuery(query);
+    const std::vector<double> inverse_document_freqs = ComputeInverseDocumentFreqs(query);
+
+    return std::transform_reduce(
+        execution_policy,
+        shards_.begin(), shards_.end(),
+        TopDocuments(max_document_count),
+        [](TopDocuments lhs, const TopDocuments& rhs) {
+            lhs.Merge(rhs);
+            return lhs;
+        },
+        [&](const SearchServer& shard) {
+            return shard.FindDocumentsInRange(
+                shard.FindQueryPostings(query, inverse_document_freqs),
+                doc_predicate,
+                0, shard.ordinal_to_document_.size(),
+                max_document_count
+            );
+        }
+    ).Build();
+}
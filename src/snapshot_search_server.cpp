@@ -0,0 +1,106 @@
+#include "snapshot_search_server.h"
+
+SnapshotSearchServer::~SnapshotSearchServer() {
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        is_stopped_ = true;
+    }
+    merge_cv_.notify_one();
+    merge_thread_.join();
+}
+
+void SnapshotSearchServer::WaitForMerges() {
+    std::unique_lock<std::mutex> lock(merge_mutex_);
+    idle_cv_.wait(lock, [this] { return !has_changes_ && !is_merging_; });
+    if (merge_error_)
+        std::rethrow_exception(std::exchange(merge_error_, nullptr));
+}
+
+void SnapshotSearchServer::AddDocument(
+    int document_id,
+    const std::string_view& text,
+    DocumentStatus status,
+    const std::vector<int>& ratings
+)
+{
+    AddDocuments({{document_id, text, status, ratings}});
+}
+
+void SnapshotSearchServer::RemoveDocument(int document_id) {
+    RemoveDocuments({document_id});
+}
+
+void SnapshotSearchServer::RemoveDocuments(const std::vector<int>& document_ids) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const std::shared_ptr<const IndexSnapshot> snapshot = std::atomic_load(&snapshot_);
+    Publish(snapshot->RemoveDocuments(document_ids));
+}
+
+void SnapshotSearchServer::ThrowInvalidDocumentIds(
+    const IndexSnapshot& snapshot,
+    const std::vector<RawDocument>& documents
+) const
+{
+    // Ids of removed documents are free, although their segments still
+    // contain them, so ids are checked against the snapshot here
+    for (const RawDocument& document : documents)
+        if (snapshot.HasDocument(document.id))
+            throw std::invalid_argument(
+                "already used id --> " + std::to_string(document.id)
+            );
+}
+
+void SnapshotSearchServer::Publish(std::shared_ptr<const IndexSnapshot> snapshot) {
+    std::atomic_store(&snapshot_, std::move(snapshot));
+    {
+        std::lock_guard<std::mutex> lock(merge_mutex_);
+        has_changes_ = true;
+    }
+    merge_cv_.notify_one();
+}
+
+void SnapshotSearchServer::MergeInBackground() {
+    std::unique_lock<std::mutex> lock(merge_mutex_);
+    while (true) {
+        merge_cv_.wait(lock, [this] { return has_changes_ || is_stopped_; });
+        if (is_stopped_)
+            return;
+
+        has_changes_ = false;
+        is_merging_ = true;
+        lock.unlock();
+        // An exception escaping the thread would terminate the process, so
+        // a failed merge keeps the current snapshot and reports the error
+        std::exception_ptr error;
+        try {
+            MergeSegments();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error)
+            merge_error_ = error;
+        is_merging_ = false;
+        idle_cv_.notify_all();
+    }
+}
+
+void SnapshotSearchServer::MergeSegments() {
+    while (!is_stopped_) {
+        const std::shared_ptr<const IndexSnapshot> snapshot = GetSnapshot();
+        const std::vector<size_t> segments = snapshot->SelectSegmentsToMerge(merge_options_);
+        if (segments.empty())
+            return;
+
+        // The merge is built without blocking writers, which may remove
+        // documents of the merged segments meanwhile
+        std::shared_ptr<const SearchServer> merged = snapshot->MergeSegments(segments);
+
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        std::atomic_store(
+            &snapshot_,
+            std::atomic_load(&snapshot_)->ReplaceSegments(*snapshot, segments,
+                                                          std::move(merged))
+        );
+    }
+}
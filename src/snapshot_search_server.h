@@ -0,0 +1,214 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "index_snapshot.h"
+#include "search_server.h"
+
+// Search server serving queries while documents are added and removed.
+// Readers use the snapshot published last and never wait for writers,
+// which are serialized, make a new snapshot sharing unchanged segments
+// with the current one and publish it atomically. A snapshot stays valid
+// as long as a reader holds it.
+//
+// Every write of documents adds a small segment. A background thread
+// merges segments by the tiered policy of IndexSnapshot::MergeOptions,
+// dropping removed documents, and publishes the result like a writer,
+// so the merge cost is paid neither by writers nor by queries.
+class SnapshotSearchServer {
+public:
+    using MergeOptions = IndexSnapshot::MergeOptions;
+
+    SnapshotSearchServer()
+        : SnapshotSearchServer(std::vector<std::string>{})
+    {
+    }
+
+    explicit SnapshotSearchServer(const std::string& stop_words_text,
+                                  const MergeOptions& merge_options = {})
+        : SnapshotSearchServer(SplitIntoWordsView(stop_words_text), merge_options)
+    {
+    }
+
+    explicit SnapshotSearchServer(const std::string_view& stop_words_text,
+                                  const MergeOptions& merge_options = {})
+        : SnapshotSearchServer(SplitIntoWordsView(stop_words_text), merge_options)
+    {
+    }
+
+    template <typename StringContainer>
+    explicit SnapshotSearchServer(const StringContainer& stop_words,
+                                  const MergeOptions& merge_options = {});
+
+    SnapshotSearchServer(const SnapshotSearchServer&) = delete;
+
+    SnapshotSearchServer& operator=(const SnapshotSearchServer&) = delete;
+
+    ~SnapshotSearchServer();
+
+    // Blocks until the background thread has nothing to merge. Rethrows the
+    // error of a failed merge, whose segments stay published unmerged.
+    void WaitForMerges();
+
+    // Snapshot for a series of consistent queries
+    inline std::shared_ptr<const IndexSnapshot> GetSnapshot() const {
+        return std::atomic_load(&snapshot_);
+    }
+
+    inline int GetDocumentCount() const {
+        return GetSnapshot()->GetDocumentCount();
+    }
+
+    void AddDocument(
+        int document_id,
+        const std::string_view& text,
+        DocumentStatus status,
+        const std::vector<int>& ratings
+    );
+
+    inline void AddDocuments(const std::vector<RawDocument>& documents) {
+        AddDocuments(std::execution::seq, documents);
+    }
+
+    // Adds a batch of documents as a single segment
+    template <typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy execution_policy,
+                      const std::vector<RawDocument>& documents);
+
+    void RemoveDocument(int document_id);
+
+    void RemoveDocuments(const std::vector<int>& document_ids);
+
+    inline std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        const std::string_view& raw_query,
+        int document_id
+    ) const
+    {
+        return GetSnapshot()->MatchDocument(raw_query, document_id);
+    }
+
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        int document_id
+    ) const
+    {
+        return GetSnapshot()->MatchDocument(execution_policy, raw_query, document_id);
+    }
+
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return GetSnapshot()->FindTopDocuments(raw_query, status_to_find,
+                                               max_document_count);
+    }
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentStatus status_to_find = DocumentStatus::ACTUAL,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return GetSnapshot()->FindTopDocuments(execution_policy, raw_query,
+                                               status_to_find, max_document_count);
+    }
+
+    template <typename DocumentPredicate>
+    inline std::vector<Document> FindTopDocuments(
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return GetSnapshot()->FindTopDocuments(raw_query, doc_predicate,
+                                               max_document_count);
+    }
+
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(
+        ExecutionPolicy execution_policy,
+        const std::string_view& raw_query,
+        DocumentPredicate doc_predicate,
+        size_t max_document_count = MAX_RESULT_DOCUMENT_COUNT
+    ) const
+    {
+        return GetSnapshot()->FindTopDocuments(execution_policy, raw_query,
+                                               doc_predicate, max_document_count);
+    }
+
+private:
+    std::vector<std::string> stop_words_;
+    MergeOptions merge_options_;
+    // Accessed by std::atomic_load() and std::atomic_store() only
+    std::shared_ptr<const IndexSnapshot> snapshot_;
+    std::mutex write_mutex_;
+
+    // State of the background merge guarded by merge_mutex_
+    std::mutex merge_mutex_;
+    std::condition_variable merge_cv_;
+    std::condition_variable idle_cv_;
+    bool has_changes_ = false;
+    bool is_merging_ = false;
+    std::exception_ptr merge_error_;
+    std::atomic_bool is_stopped_ = false;
+    std::thread merge_thread_;
+
+    void ThrowInvalidDocumentIds(const IndexSnapshot& snapshot,
+                                 const std::vector<RawDocument>& documents) const;
+
+    // Publishes a snapshot made by a writer, which must hold write_mutex_
+    void Publish(std::shared_ptr<const IndexSnapshot> snapshot);
+
+    void MergeInBackground();
+
+    // Merges segments while the policy selects some
+    void MergeSegments();
+};
+
+
+/* ------------------------------- TEMPLATES ------------------------------- */
+
+template <typename StringContainer>
+SnapshotSearchServer::SnapshotSearchServer(const StringContainer& stop_words,
+                                           const MergeOptions& merge_options)
+    : stop_words_(stop_words.begin(), stop_words.end())
+    , merge_options_(merge_options)
+    , snapshot_(std::make_shared<IndexSnapshot>(
+          std::make_shared<const SearchServer>(stop_words_)
+      ))
+    , merge_thread_(&SnapshotSearchServer::MergeInBackground, this)
+{
+}
+
+template <typename ExecutionPolicy>
+void SnapshotSearchServer::AddDocuments(ExecutionPolicy execution_policy,
+                                        const std::vector<RawDocument>& documents)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const std::shared_ptr<const IndexSnapshot> snapshot = std::atomic_load(&snapshot_);
+    ThrowInvalidDocumentIds(*snapshot, documents);
+
+    // The segment is built aside, so readers go on using the current snapshot
+    auto segment = std::make_shared<SearchServer>(stop_words_);
+    segment->AddDocuments(execution_policy, documents);
+    Publish(snapshot->AddSegment(std::move(segment)));
+}
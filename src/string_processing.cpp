@@ -53,24 +53,8 @@ std::vector<std::string> GenerateQueries(
 
 std::vector<std::string_view> SplitIntoWordsView(std::string_view text) {
     std::vector<std::string_view> words;
-
-    const size_t pos_end = text.npos;
-    while (true) {
-        size_t space = text.find(' ');
-        std::string_view word = text.substr(0, space);
-
+    ForEachWord(text, [&words](std::string_view word) {
         words.push_back(word);
-
-        if (space == pos_end)
-            break;
-        else
-            text.remove_prefix(space + 1);
-    }
-
-    // The last element of words vector will be empty
-    // if a text at its end contains spaces
-    if (words.back().empty())
-        words.pop_back();
-
+    });
     return words;
 }
\ No newline at end of file
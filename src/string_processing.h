@@ -52,8 +52,22 @@ inline std::vector<std::string> SplitIntoWords(const std::string_view& text) {
     return SplitIntoWords(std::execution::seq, text);
 }
 
+// Non-empty space separated words as views of text, nothing is copied
 std::vector<std::string_view> SplitIntoWordsView(std::string_view text);
 
+// Calls function for every non-empty space separated word of text
+template <typename Function>
+void ForEachWord(std::string_view text, Function function) {
+    while (!text.empty()) {
+        const size_t space = text.find(' ');
+        if (space != 0)
+            function(text.substr(0, space));
+        if (space == text.npos)
+            break;
+        text.remove_prefix(space + 1);
+    }
+}
+
 template <typename StringContainer>
 std::set<std::string, std::less<>> MakeUniqueNonEmptyWords(
     const StringContainer& words
@@ -62,7 +76,7 @@ std::set<std::string, std::less<>> MakeUniqueNonEmptyWords(
     std::set<std::string, std::less<>> non_empty_strings;
     for (const auto& word : words) {
         if (!word.empty())
-            non_empty_strings.insert(word);
+            non_empty_strings.emplace(word);
     }
 
     return non_empty_strings;
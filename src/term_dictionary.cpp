@@ -0,0 +1,58 @@
+#include "term_dictionary.h"
+
+TermDictionary::TermDictionary(const TermDictionary& other) {
+    *this = other;
+}
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        words_ = other.words_;
+        free_terms_ = other.free_terms_;
+        word_to_term_.clear();
+        word_to_term_.reserve(words_.size());
+        for (size_t term_id = 0; term_id < words_.size(); ++term_id)
+            if (!words_[term_id].empty())
+                word_to_term_.emplace(words_[term_id], term_id);
+    }
+    return *this;
+}
+
+TermDictionary& TermDictionary::operator=(TermDictionary&& other) {
+    if (words_.get_allocator() != other.words_.get_allocator())
+        return *this = static_cast<const TermDictionary&>(other);
+
+    words_ = std::move(other.words_);
+    word_to_term_ = std::move(other.word_to_term_);
+    free_terms_ = std::move(other.free_terms_);
+    return *this;
+}
+
+int TermDictionary::Add(std::string_view word) {
+    const auto it = word_to_term_.find(word);
+    if (it != word_to_term_.end())
+        return it->second;
+
+    if (!free_terms_.empty()) {
+        const int term_id = free_terms_.back();
+        free_terms_.pop_back();
+        words_[term_id] = word;
+        word_to_term_.emplace(words_[term_id], term_id);
+        return term_id;
+    }
+
+    const int term_id = words_.size();
+    words_.emplace_back(word);
+    word_to_term_.emplace(words_.back(), term_id);
+    return term_id;
+}
+
+int TermDictionary::Find(std::string_view word) const {
+    const auto it = word_to_term_.find(word);
+    return it != word_to_term_.end() ? it->second : NOT_FOUND;
+}
+
+void TermDictionary::Remove(int term_id) {
+    word_to_term_.erase(words_[term_id]);
+    words_[term_id] = {};
+    free_terms_.push_back(term_id);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_pool.h"
+
+// Interns words: every distinct word is stored once and numbered by a dense
+// term id, so the index and documents refer to words by integers only.
+// Ids of removed words are reused by words added later.
+class TermDictionary {
+public:
+    static const int NOT_FOUND = -1;
+
+    TermDictionary() = default;
+
+    TermDictionary(const TermDictionary& other);
+
+    TermDictionary& operator=(const TermDictionary& other);
+
+    TermDictionary(TermDictionary&& other) = default;
+
+    // Views of words survive a move of words_ only if the memory is moved
+    // with it, so words of a dictionary of another pool are copied
+    TermDictionary& operator=(TermDictionary&& other);
+
+    inline size_t size() const noexcept {
+        return words_.size() - free_terms_.size();
+    }
+
+    // Term id of the word, which is added if it is not known yet
+    int Add(std::string_view word);
+
+    // Term id of the word or NOT_FOUND
+    int Find(std::string_view word) const;
+
+    void Remove(int term_id);
+
+    inline std::string_view GetWord(int term_id) const {
+        return words_[term_id];
+    }
+
+private:
+    // Views of word_to_term_ refer to strings of words_, which keep their
+    // addresses while the deque grows. Removed words are left empty.
+    MemoryPool memory_;
+    std::pmr::deque<std::pmr::string> words_{memory_.get()};
+    std::pmr::unordered_map<std::string_view, int> word_to_term_{memory_.get()};
+    std::vector<int> free_terms_;
+};
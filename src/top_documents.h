@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "document.h"
+
+// Bounded selection of the most relevant documents: keeps a heap of at most
+// max_count documents whose front is the worst one kept so far
+class TopDocuments {
+public:
+    // Memory is not reserved up front, since max_count may be far more
+    // than the documents ever found
+    explicit TopDocuments(size_t max_count)
+        : max_count_(max_count)
+    {
+    }
+
+    // Relevance descending, then rating descending, then id ascending
+    static bool IsBetter(const Document& lhs, const Document& rhs) {
+        if (std::abs(lhs.relevance - rhs.relevance) >= 1e-6)
+            return lhs.relevance > rhs.relevance;
+        if (lhs.rating != rhs.rating)
+            return lhs.rating > rhs.rating;
+        return lhs.id < rhs.id;
+    }
+
+    void Add(const Document& document) {
+        if (documents_.size() < max_count_) {
+            documents_.push_back(document);
+            std::push_heap(documents_.begin(), documents_.end(), IsBetter);
+        } else if (max_count_ && IsBetter(document, documents_.front())) {
+            std::pop_heap(documents_.begin(), documents_.end(), IsBetter);
+            documents_.back() = document;
+            std::push_heap(documents_.begin(), documents_.end(), IsBetter);
+        }
+    }
+
+    void Merge(const TopDocuments& other) {
+        for (const Document& document : other.documents_)
+            Add(document);
+    }
+
+    // Kept documents from the best to the worst
+    std::vector<Document> Build() && {
+        std::sort_heap(documents_.begin(), documents_.end(), IsBetter);
+        return std::move(documents_);
+    }
+
+private:
+    size_t max_count_;
+    std::vector<Document> documents_;
+};
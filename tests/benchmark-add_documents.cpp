@@ -0,0 +1,57 @@
+#include <execution>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "log_duration.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+void TestLoop(string_view mark, const vector<RawDocument>& documents) {
+    SearchServer search_server;
+    {
+        LOG_DURATION_STDERR(mark);
+        for (const RawDocument& document : documents)
+            search_server.AddDocument(document.id, document.text,
+                                      document.status, document.ratings);
+    }
+    cout << search_server.GetDocumentCount() << endl;
+}
+
+template <typename ExecutionPolicy>
+void TestBatch(string_view mark, const vector<RawDocument>& documents,
+               ExecutionPolicy&& policy) {
+    SearchServer search_server;
+    {
+        LOG_DURATION_STDERR(mark);
+        search_server.AddDocuments(policy, documents);
+    }
+    cout << search_server.GetDocumentCount() << endl;
+}
+
+int main(int argc, char** argv) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+
+    vector<int> document_counts = {100'000, 1'000'000};
+    if (argc > 1)
+        document_counts.assign({stoi(argv[1])});
+
+    for (const int document_count : document_counts) {
+        const auto texts = GenerateQueries(generator, dictionary, document_count, 20);
+
+        vector<RawDocument> documents;
+        documents.reserve(texts.size());
+        for (size_t i = 0; i < texts.size(); ++i)
+            documents.push_back({static_cast<int>(i), texts[i], DocumentStatus::ACTUAL, {1, 2, 3}});
+
+        cout << document_count << " documents:" << endl;
+        TestLoop("AddDocument loop"sv, documents);
+        TestBatch("AddDocuments seq"sv, documents, execution::seq);
+        TestBatch("AddDocuments par"sv, documents, execution::par);
+    }
+}
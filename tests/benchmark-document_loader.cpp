@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "document_loader.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+void PrintQueueStats(const string& name, const BoundedQueueStats& stats) {
+    cout << "    " << name << " queue: capacity " << stats.capacity
+         << ", " << stats.push_count << " pushes"
+         << ", depth " << stats.average_depth << " on average, " << stats.max_depth << " at most"
+         << ", " << stats.blocked_push_count << " pushes blocked" << endl;
+}
+
+// Compares adding records read line by line with the loader pipeline
+void TestLoad(int document_count) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const string path = filesystem::temp_directory_path() / "benchmark-document_loader.tsv";
+    {
+        ofstream out(path);
+        for (int id = 0; id < document_count; ++id)
+            out << id << "\t0\t1 2 3\t" << GenerateQuery(generator, dictionary, 50) << '\n';
+    }
+    cout << document_count << " documents, "
+         << filesystem::file_size(path)/(1 << 20) << " MiB:" << endl;
+
+    {
+        SearchServer search_server(dictionary[0]);
+        const auto start_time = chrono::steady_clock::now();
+        ifstream in(path);
+        for (string line; getline(in, line);) {
+            const RawDocument document = DocumentLoader::ParseRecord(line);
+            search_server.AddDocument(document.id, document.text, document.status,
+                                      document.ratings);
+        }
+        const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+        cout << "    getline and AddDocument: "
+             << document_count/duration.count() << " documents/s" << endl;
+    }
+    {
+        SearchServer search_server(dictionary[0]);
+        const DocumentLoader::Stats stats = DocumentLoader(search_server).Load(path);
+        cout << "    DocumentLoader: " << stats.documents_per_second << " documents/s" << endl;
+        PrintQueueStats("chunk", stats.chunk_queue);
+        PrintQueueStats("batch", stats.batch_queue);
+    }
+
+    remove(path.c_str());
+}
+
+int main() {
+    TestLoad(1'000'000);
+}
@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "log_duration.h"
+#include "mapped_search_server.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+// Compares rebuilding an index from texts with opening its saved file
+void TestStartup(int document_count) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, document_count, 50);
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 5);
+    const string path = filesystem::temp_directory_path() / "benchmark-mapped_search_server.index";
+
+    cout << document_count << " documents:" << endl;
+    SearchServer search_server(dictionary[0]);
+    {
+        LOG_DURATION_STDERR("AddDocument"sv);
+        for (int id = 0; id < document_count; ++id)
+            search_server.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {1, 2, 3});
+    }
+    {
+        LOG_DURATION_STDERR("Save"sv);
+        search_server.Save(path);
+    }
+    cout << filesystem::file_size(path)/(1 << 20) << " MiB file" << endl;
+
+    {
+        LOG_DURATION_STDERR("Open with checksum"sv);
+        MappedSearchServer::Open(path);
+    }
+
+    // The file was just written, so it is trusted like a deployed index
+    const bool skip_checksum = true;
+    const auto open_start_time = chrono::steady_clock::now();
+    const MappedSearchServer mapped_server = MappedSearchServer::Open(path, skip_checksum);
+    const auto first_query_start_time = chrono::steady_clock::now();
+    mapped_server.FindTopDocuments(queries[0]);
+    const auto end_time = chrono::steady_clock::now();
+    cout << chrono::duration<double, milli>(first_query_start_time - open_start_time).count()
+         << " ms to open without checksum, "
+         << chrono::duration<double, milli>(end_time - first_query_start_time).count()
+         << " ms to the first query" << endl;
+
+    for (const auto& [name, find_top_documents] : {
+             pair<string, function<void(const string&)>>(
+                 "SearchServer", [&](const string& query) { search_server.FindTopDocuments(query); }),
+             pair<string, function<void(const string&)>>(
+                 "MappedSearchServer", [&](const string& query) { mapped_server.FindTopDocuments(query); })}) {
+        const auto start_time = chrono::steady_clock::now();
+        for (const string& query : queries)
+            find_top_documents(query);
+        const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+        cout << name << ": " << queries.size()/duration.count() << " queries/s" << endl;
+    }
+
+    remove(path.c_str());
+}
+
+int main() {
+    TestStartup(1'000'000);
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <execution>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "memory_usage.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+template <typename Match>
+void TestMatch(string_view mark, const SearchServer& search_server,
+               const vector<string>& queries, Match match) {
+    const int document_count = search_server.GetDocumentCount();
+
+    const size_t allocation_count = memory_usage::GetAllocationCount();
+    const auto start_time = chrono::steady_clock::now();
+
+    size_t matched_count = 0;
+    size_t call_count = 0;
+    for (const string& query : queries) {
+        for (int id = 0; id < document_count; ++id, ++call_count)
+            matched_count += match(query, id);
+    }
+
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+    const size_t allocations = memory_usage::GetAllocationCount() - allocation_count;
+    cout << mark << ": " << matched_count << " words matched, "
+         << call_count/duration.count() << " calls/s, "
+         << static_cast<double>(allocations)/call_count << " allocations/call" << endl;
+}
+
+#define TEST_POLICY(mode) \
+    TestMatch("MatchDocument "#mode, search_server, queries, \
+              [&search_server, &matched_words](const string& query, int id) { \
+                  search_server.MatchDocument(execution::mode, query, id, matched_words); \
+                  return matched_words.size(); \
+              })
+
+void TestLongQueries() {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 50'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 100, 10'000);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 500);
+
+    SearchServer search_server;
+    for (size_t i = 0; i < documents.size(); ++i)
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+
+    vector<string_view> matched_words;
+    TEST_POLICY(seq);
+    TEST_POLICY(par);
+}
+
+int main() {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, 1'000, 100);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 10);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < documents.size(); ++i)
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
+
+    TestMatch("MatchDocument tuple", search_server, queries,
+              [&search_server](const string& query, int id) {
+                  const auto [matched_words, status] = search_server.MatchDocument(query, id);
+                  return matched_words.size();
+              });
+
+    vector<string_view> matched_words;
+    TestMatch("MatchDocument buffer", search_server, queries,
+              [&search_server, &matched_words](const string& query, int id) {
+                  search_server.MatchDocument(query, id, matched_words);
+                  return matched_words.size();
+              });
+
+    TestLongQueries();
+    return 0;
+}
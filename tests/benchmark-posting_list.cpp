@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_usage.h"
+#include "posting_list.h"
+#include "string_processing.h"
+
+using namespace std;
+
+// (term id, term frequency) of the distinct words of every document,
+// computed like SearchServer does
+vector<vector<pair<int, double>>> TokenizeDocuments(const vector<string>& dictionary,
+                                                    const vector<string>& texts) {
+    unordered_map<string_view, int> word_to_term;
+    for (const string& word : dictionary)
+        word_to_term.emplace(word, word_to_term.size());
+
+    vector<vector<pair<int, double>>> documents;
+    documents.reserve(texts.size());
+    for (const string& text : texts) {
+        vector<string_view> words = SplitIntoWordsView(text);
+        sort(words.begin(), words.end());
+
+        const double inv_word_count = 1.0/words.size();
+        vector<pair<int, double>>& document = documents.emplace_back();
+        for (size_t i = 0; i < words.size(); ++i) {
+            if (i == 0 || words[i] != words[i - 1])
+                document.emplace_back(word_to_term.at(words[i]), 0.0);
+            document.back().second += inv_word_count;
+        }
+    }
+    return documents;
+}
+
+template <typename Postings, typename Add, typename ForEach>
+void TestPostings(string_view mark,
+                  size_t term_count,
+                  const vector<vector<pair<int, double>>>& documents,
+                  Add add,
+                  ForEach for_each) {
+    const size_t allocated_bytes = memory_usage::GetAllocatedBytes();
+    const auto build_start_time = chrono::steady_clock::now();
+    vector<Postings> term_postings(term_count);
+    size_t posting_count = 0;
+    for (size_t ordinal = 0; ordinal < documents.size(); ++ordinal) {
+        for (const auto& [term_id, term_freq] : documents[ordinal])
+            add(term_postings[term_id], ordinal, term_freq);
+        posting_count += documents[ordinal].size();
+    }
+    const chrono::duration<double> build_duration = chrono::steady_clock::now() - build_start_time;
+    const size_t bytes = memory_usage::GetAllocatedBytes() - allocated_bytes;
+
+    // Every list is read whole and by chunks of ordinals like a parallel query
+    const int chunk_size = 1 << 16;
+    const auto start_time = chrono::steady_clock::now();
+    double term_freq_sum = 0.0;
+    size_t read_count = 0;
+    for (const Postings& postings : term_postings) {
+        for_each(postings, 0, documents.size(), [&](int, double term_freq) {
+            term_freq_sum += term_freq;
+            ++read_count;
+        });
+        for (size_t first = 0; first < documents.size(); first += chunk_size)
+            for_each(postings, first, first + chunk_size, [&](int, double term_freq) {
+                term_freq_sum += term_freq;
+                ++read_count;
+            });
+    }
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+
+    cout << mark << ": " << posting_count << " postings, "
+         << static_cast<double>(bytes)/posting_count << " bytes/posting, "
+         << posting_count/build_duration.count()/1e6 << "M postings/s added, "
+         << read_count/duration.count()/1e6 << "M postings/s read, "
+         << "term frequency sum " << term_freq_sum << endl;
+}
+
+int main() {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 1'000'000, 20);
+    const auto documents = TokenizeDocuments(dictionary, texts);
+
+    TestPostings<map<int, double>>(
+        "std::map", dictionary.size(), documents,
+        [](map<int, double>& postings, int ordinal, double term_freq) {
+            postings.emplace_hint(postings.end(), ordinal, term_freq);
+        },
+        [](const map<int, double>& postings, int first, int last, auto function) {
+            for (auto it = postings.lower_bound(first); it != postings.end() && it->first < last; ++it)
+                function(it->first, it->second);
+        }
+    );
+    TestPostings<PostingList>(
+        "PostingList", dictionary.size(), documents,
+        [](PostingList& postings, int ordinal, double term_freq) {
+            postings.Add(ordinal, term_freq);
+        },
+        [](const PostingList& postings, int first, int last, auto function) {
+            postings.ForEach(first, last, function);
+        }
+    );
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "process_queries.h"
+#include "query_result_cache.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+// Log of queries drawn from distinct ones, the query of rank k
+// with probability proportional to 1/k^exponent
+vector<string> GenerateZipfLog(mt19937& generator,
+                               const vector<string>& distinct_queries,
+                               int query_count,
+                               double exponent) {
+    vector<double> weights(distinct_queries.size());
+    for (size_t rank = 0; rank < weights.size(); ++rank)
+        weights[rank] = 1.0/pow(rank + 1, exponent);
+    discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+
+    vector<string> queries;
+    queries.reserve(query_count);
+    for (int i = 0; i < query_count; ++i)
+        queries.push_back(distinct_queries[distribution(generator)]);
+    return queries;
+}
+
+// Replays the log one query after another, adding a document once in
+// write_interval queries if it is not zero
+void TestReplay(SearchServer& search_server,
+                const vector<string>& queries,
+                size_t capacity,
+                size_t write_interval = 0) {
+    optional<QueryResultCache> cache;
+    if (capacity)
+        cache.emplace(search_server, capacity);
+
+    int document_id = search_server.GetDocumentCount();
+    const auto start_time = chrono::steady_clock::now();
+    size_t found_count = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        if (write_interval && i % write_interval == 0)
+            search_server.AddDocument(document_id++, queries[i], DocumentStatus::ACTUAL, {1});
+        found_count += cache
+            ? cache->FindTopDocuments(queries[i]).size()
+            : search_server.FindTopDocuments(queries[i]).size();
+    }
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+
+    cout << (capacity ? "capacity " + to_string(capacity) : "no cache"s);
+    if (write_interval)
+        cout << ", a write every " << write_interval << " queries";
+    cout << ": " << queries.size()/duration.count() << " queries/s, "
+         << found_count << " documents found";
+    if (cache) {
+        const QueryResultCache::Stats stats = cache->GetStats();
+        cout << ", hit rate " << 100.0*stats.hit_count/(stats.hit_count + stats.miss_count) << "%, "
+             << stats.eviction_count << " evictions, "
+             << stats.invalidation_count << " invalidations";
+    }
+    cout << endl;
+}
+
+void TestProcessQueries(const SearchServer& search_server,
+                        const vector<string>& queries,
+                        size_t capacity) {
+    QueryResultCache cache(search_server, capacity);
+    for (const bool is_cached : {false, true}) {
+        const auto start_time = chrono::steady_clock::now();
+        const size_t found_count = is_cached
+            ? ProcessQueriesJoined(cache, queries).size()
+            : ProcessQueriesJoined(search_server, queries).size();
+        const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+        cout << "ProcessQueries " << (is_cached ? "cached" : "uncached") << ": "
+             << queries.size()/duration.count() << " queries/s, "
+             << found_count << " documents found" << endl;
+    }
+}
+
+int main() {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 100'000, 20);
+    const auto distinct_queries = GenerateQueries(generator, dictionary, 10'000, 5);
+
+    SearchServer search_server(dictionary[0]);
+    for (size_t i = 0; i < texts.size(); ++i)
+        search_server.AddDocument(i, texts[i], DocumentStatus::ACTUAL, {1, 2, 3});
+
+    for (const double exponent : {0.8, 1.0, 1.2}) {
+        const vector<string> queries = GenerateZipfLog(generator, distinct_queries,
+                                                       100'000, exponent);
+        cout << "Zipf exponent " << exponent << ", " << distinct_queries.size()
+             << " distinct queries" << endl;
+        TestReplay(search_server, queries, 0);
+        for (const size_t capacity : {100, 1'000, 10'000})
+            TestReplay(search_server, queries, capacity);
+        TestReplay(search_server, queries, 1'000, 1'000);
+        TestProcessQueries(search_server, queries, 1'000);
+    }
+    return 0;
+}
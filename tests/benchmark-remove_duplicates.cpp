@@ -0,0 +1,40 @@
+#include <execution>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "log_duration.h"
+#include "remove_duplicates.h"
+#include "search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+#define TEST(function, mode) \
+    { \
+        LOG_DURATION_STDERR(#function " "#mode##sv); \
+        cout << function(execution::mode, search_server).size() << " duplicates" << endl; \
+    }
+
+int main(int argc, char* argv[]) {
+    const int document_count = argc > 1 ? stoi(argv[1]) : 500'000;
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 50'000, 10);
+    auto documents = GenerateQueries(generator, dictionary, document_count, 20);
+
+    // Every tenth document repeats an earlier one with an extra word
+    for (int i = 0; i < document_count; i += 10)
+        documents[i] = documents[i/2] + ' ' + dictionary[i % dictionary.size()];
+
+    SearchServer search_server;
+    for (int id = 0; id < document_count; ++id)
+        search_server.AddDocument(id, documents[id], DocumentStatus::ACTUAL, {1, 2, 3});
+
+    TEST(FindDuplicates, seq);
+    TEST(FindDuplicates, par);
+    TEST(FindNearDuplicates, seq);
+    TEST(FindNearDuplicates, par);
+    return 0;
+}
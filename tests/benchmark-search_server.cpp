@@ -1,11 +1,18 @@
+#include <algorithm>
+#include <chrono>
 #include <execution>
 #include <iostream>
+#include <optional>
+#include <numeric>
 #include <random>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "log_duration.h"
+#include "memory_usage.h"
 #include "search_server.h"
+#include "sharded_search_server.h"
 #include "string_processing.h"
 
 using namespace std;
@@ -24,6 +31,124 @@ void Test(string_view mark, SearchServer search_server,
 
 #define TEST(mode) Test(#mode, search_server, execution::mode)
 
+template <typename Server, typename ExecutionPolicy>
+void TestQueries(string_view mark, const Server& search_server,
+                 const vector<string>& queries, ExecutionPolicy&& policy) {
+    const auto start_time = chrono::steady_clock::now();
+
+    size_t found_count = 0;
+    for (const string& query : queries)
+        found_count += search_server.FindTopDocuments(policy, query).size();
+
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+    cout << mark << ": " << found_count << " documents found, "
+         << queries.size()/duration.count() << " queries/s" << endl;
+}
+
+#define TEST_QUERIES(mode) TestQueries("FindTopDocuments "#mode, search_server, queries, execution::mode)
+
+void TestIndex(int document_count) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto documents = GenerateQueries(generator, dictionary, document_count, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 10);
+
+    size_t posting_count = 0;
+    for (const string& document : documents) {
+        const vector<string_view> words = SplitIntoWordsView(document);
+        posting_count += set<string_view>(words.begin(), words.end()).size();
+    }
+
+    const size_t allocated_bytes = memory_usage::GetAllocatedBytes();
+    const size_t allocation_count = memory_usage::GetAllocationCount();
+    SearchServer search_server;
+    for (int id = 0; id < document_count; ++id)
+        search_server.AddDocument(id, documents[id], DocumentStatus::ACTUAL, {1, 2, 3});
+    const size_t index_bytes = memory_usage::GetAllocatedBytes() - allocated_bytes;
+    const size_t index_allocation_count = memory_usage::GetAllocationCount() - allocation_count;
+
+    cout << document_count << " documents, " << posting_count << " postings: "
+         << static_cast<double>(index_bytes)/document_count << " bytes/document, "
+         << static_cast<double>(index_bytes)/posting_count << " bytes/posting, "
+         << static_cast<double>(index_allocation_count)/document_count << " allocations/document"
+         << endl;
+
+    {
+        const size_t copy_allocation_count = memory_usage::GetAllocationCount();
+        optional<SearchServer> copy(search_server);
+        const size_t copy_allocations = memory_usage::GetAllocationCount() - copy_allocation_count;
+
+        const auto start_time = chrono::steady_clock::now();
+        copy.reset();
+        const chrono::duration<double, milli> duration = chrono::steady_clock::now() - start_time;
+        cout << "copy of the index: " << copy_allocations << " allocations, destroyed in "
+             << duration.count() << " ms" << endl;
+    }
+
+    TEST_QUERIES(seq);
+    TEST_QUERIES(par);
+
+    vector<RawDocument> raw_documents;
+    for (int id = 0; id < document_count; ++id)
+        raw_documents.push_back({id, documents[id], DocumentStatus::ACTUAL, {1, 2, 3}});
+    ShardedSearchServer sharded_server;
+    sharded_server.AddDocuments(execution::par, raw_documents);
+
+    TestQueries("ShardedSearchServer seq", sharded_server, queries, execution::seq);
+    TestQueries("ShardedSearchServer par", sharded_server, queries, execution::par);
+}
+
+template <typename Remove>
+void TestRemoval(string_view mark, SearchServer search_server,
+                 const vector<int>& ids, Remove remove) {
+    const auto start_time = chrono::steady_clock::now();
+    remove(search_server, ids);
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+
+    cout << mark << ": " << search_server.GetDocumentCount() << " documents left, "
+         << ids.size()/duration.count() << " removals/s" << endl;
+}
+
+#define TEST_REMOVE_DOCUMENT(mode) \
+    TestRemoval("RemoveDocument "#mode, search_server, ids, \
+                [](SearchServer& search_server, const vector<int>& ids) { \
+                    for (const int id : ids) \
+                        search_server.RemoveDocument(execution::mode, id); \
+                })
+
+#define TEST_REMOVE_DOCUMENTS(mode) \
+    TestRemoval("RemoveDocuments "#mode, search_server, ids, \
+                [](SearchServer& search_server, const vector<int>& ids) { \
+                    search_server.RemoveDocuments(execution::mode, ids); \
+                })
+
+// Removes 10% of documents one by one and in a batch
+void TestRemoveDocuments(int document_count) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, document_count, 20);
+
+    vector<RawDocument> documents;
+    documents.reserve(document_count);
+    for (int id = 0; id < document_count; ++id)
+        documents.push_back({id, texts[id], DocumentStatus::ACTUAL, {1, 2, 3}});
+
+    SearchServer search_server;
+    search_server.AddDocuments(execution::par, documents);
+
+    vector<int> ids(document_count);
+    iota(ids.begin(), ids.end(), 0);
+    shuffle(ids.begin(), ids.end(), generator);
+    ids.resize(document_count/10);
+
+    TEST_REMOVE_DOCUMENT(seq);
+    TEST_REMOVE_DOCUMENT(par);
+    TEST_REMOVE_DOCUMENTS(seq);
+    TEST_REMOVE_DOCUMENTS(par);
+}
+
 int main() {
     mt19937 generator;
 
@@ -36,4 +161,7 @@ int main() {
 
     TEST(seq);
     TEST(par);
-}
\ No newline at end of file
+
+    TestIndex(100'000);
+    TestRemoveDocuments(1'000'000);
+}
@@ -0,0 +1,59 @@
+#include <atomic>
+#include <chrono>
+#include <execution>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "snapshot_search_server.h"
+#include "string_processing.h"
+
+using namespace std;
+
+// Adds documents in small batches while another thread runs queries,
+// and reports the rates of both and the number of segments left
+void TestIngestion(int document_count, int batch_size) {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, document_count, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 1'000, 10);
+
+    SnapshotSearchServer search_server;
+    atomic_bool is_writing = true;
+    size_t query_count = 0;
+    thread reader([&] {
+        while (is_writing)
+            search_server.FindTopDocuments(queries[query_count++ % queries.size()]);
+    });
+
+    const auto start_time = chrono::steady_clock::now();
+    for (int first_id = 0; first_id < document_count; first_id += batch_size) {
+        vector<RawDocument> documents;
+        for (int id = first_id; id < min(first_id + batch_size, document_count); ++id)
+            documents.push_back({id, texts[id], DocumentStatus::ACTUAL, {1, 2, 3}});
+        search_server.AddDocuments(documents);
+    }
+    const chrono::duration<double> write_duration = chrono::steady_clock::now() - start_time;
+    is_writing = false;
+    reader.join();
+
+    const size_t segment_count = search_server.GetSnapshot()->GetSegmentCount();
+    search_server.WaitForMerges();
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+
+    cout << "batches of " << batch_size << ": "
+         << document_count/write_duration.count() << " documents/s, "
+         << query_count/write_duration.count() << " queries/s while writing, "
+         << segment_count << " segments after writing, "
+         << search_server.GetSnapshot()->GetSegmentCount() << " segments once merged, "
+         << duration.count() << " s in total" << endl;
+}
+
+int main() {
+    TestIngestion(100'000, 10);
+    TestIngestion(100'000, 1'000);
+    return 0;
+}
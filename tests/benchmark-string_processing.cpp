@@ -1,16 +1,70 @@
+#include <chrono>
 #include <iterator>
 #include <iostream>
 #include <random>
 #include <numeric>
+#include <set>
 #include <string>
 #include <sstream>
 #include <vector>
 
 #include "log_duration.h"
+#include "search_server.h"
 #include "string_processing.h"
 
+using namespace std;
+
+// Runs tokenize over all texts and returns the rate of tokens
+template <typename Tokenize>
+double MeasureTokens(const vector<string>& texts, Tokenize tokenize) {
+    size_t token_count = 0;
+    const auto start_time = chrono::steady_clock::now();
+    for (const string& text : texts)
+        token_count += tokenize(text);
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start_time;
+    return token_count/duration.count();
+}
+
+// Compares the ingest path copying every token into strings
+// with the one keeping views of the text
+void TestIngestTokens() {
+    mt19937 generator;
+
+    const auto dictionary = GenerateDictionary(generator, 10'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 100'000, 100);
+    const set<string, less<>> stop_words(dictionary.begin(), dictionary.begin() + 100);
+
+    const double copying_rate = MeasureTokens(texts, [&stop_words](const string& text) {
+        vector<string> words;
+        for (const string& word : SplitIntoWords(text))
+            if (!stop_words.count(word))
+                words.push_back(word);
+        const set<string> unique_words(words.begin(), words.end());
+        return words.size();
+    });
+    const double view_rate = MeasureTokens(texts, [&stop_words](const string& text) {
+        vector<string_view> words;
+        ForEachWord(text, [&stop_words, &words](string_view word) {
+            if (!stop_words.count(word))
+                words.push_back(word);
+        });
+        sort(words.begin(), words.end());
+        return words.size();
+    });
+
+    SearchServer search_server(vector<string>(dictionary.begin(), dictionary.begin() + 100));
+    int id = 0;
+    const double server_rate = MeasureTokens(texts, [&search_server, &id](const string& text) {
+        search_server.AddDocument(id++, text, DocumentStatus::ACTUAL, {1, 2, 3});
+        return SplitIntoWordsView(text).size();
+    });
+
+    cout << copying_rate << " tokens/s by SplitIntoWords with copies, "
+         << view_rate << " tokens/s by string_view, "
+         << server_rate << " tokens/s by AddDocument" << endl;
+}
+
 int main() {
-    using namespace std;
     mt19937 generator;
 
     const auto words = GenerateDictionary(generator, 300'000, 15);
@@ -27,6 +81,11 @@ int main() {
         LOG_DURATION_STDERR("SplitIntoWords"sv);
         SplitIntoWords(text);
     }
+    {
+        LOG_DURATION_STDERR("SplitIntoWordsView"sv);
+        SplitIntoWordsView(text);
+    }
 
+    TestIngestTokens();
     return 0;
-}
\ No newline at end of file
+}
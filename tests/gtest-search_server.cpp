@@ -1,12 +1,25 @@
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <fstream>
+#include <limits>
 #include <numeric>
+#include <thread>
 
 #include <gtest/gtest.h>
 
+#include "bounded_queue.h"
+#include "document_loader.h"
+#include "mapped_search_server.h"
 #include "paginator.h"
+#include "posting_list.h"
 #include "process_queries.h"
 #include "remove_duplicates.h"
 #include "request_queue.h"
 #include "search_server.h"
+#include "sharded_search_server.h"
+#include "snapshot_search_server.h"
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -61,6 +74,72 @@ TEST(SearchServer, AddDocument) {
         << "AddDocument() must add documents";
 }
 
+TEST(SearchServer, AddDocuments) {
+    SearchServer expected_server("and with"sv);
+    AddDocuments(expected_server);
+
+    const std::vector<RawDocument> documents = {
+        {1, "funny pet and nasty rat", DocumentStatus::ACTUAL, {7, 2, 7}},
+        {2, "funny pet with curly hair", DocumentStatus::ACTUAL, {4, 2, 3}},
+        {3, "white stily mouse round ball", DocumentStatus::ACTUAL, {8, -3}},
+        {4, "mouse round thin tail", DocumentStatus::ACTUAL, {7, 2, 7}},
+        {5, "bird round sunglasses", DocumentStatus::ACTUAL, {5, -12, 2, 1}},
+        {6, "snake without tooth", DocumentStatus::IRRELEVANT, {5, 3, 4}},
+        {7, "long fat snake", DocumentStatus::BANNED, {5, -1, 3, -3}},
+    };
+    SearchServer search_server("and with"sv);
+    search_server.AddDocuments(std::execution::par, documents);
+    search_server.AddDocuments({
+        {8, "funny pet with curly hair", DocumentStatus::ACTUAL, {3, 0}},
+        {9, "funny pet and curly hair", DocumentStatus::ACTUAL, {2, 3, -1}},
+        {10, "funny funny pet and nasty nasty rat", DocumentStatus::ACTUAL, {0, 3}},
+        {11, "funny pet and not very nasty rat", DocumentStatus::ACTUAL, {1, 1, 2}},
+        {12, "very nasty rat and not very funny pet", DocumentStatus::ACTUAL, {3}},
+        {13, "pet with rat and rat and rat", DocumentStatus::ACTUAL, {1, 0, -1}},
+        {14, "nasty rat with curly hair", DocumentStatus::ACTUAL, {3, 2}},
+    });
+
+    ASSERT_EQ(expected_server.GetDocumentCount(), search_server.GetDocumentCount());
+    for (const std::string_view query : {"funny nasty rat"sv, "curly -hair"sv, "snake"sv}) {
+        const std::vector<Document> expected = expected_server.FindTopDocuments(query);
+        const std::vector<Document> found = search_server.FindTopDocuments(query);
+        ASSERT_EQ(expected.size(), found.size()) << query;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(expected[i].id, found[i].id) << query;
+            EXPECT_DOUBLE_EQ(expected[i].relevance, found[i].relevance) << query;
+            EXPECT_EQ(expected[i].rating, found[i].rating) << query;
+        }
+    }
+    ASSERT_EQ(expected_server.GetWordFrequencies(13), search_server.GetWordFrequencies(13));
+}
+
+TEST(SearchServer, AddDocumentsByInvalidBatch) {
+    SearchServer search_server;
+    search_server.AddDocument(1, "funny pet", DocumentStatus::ACTUAL, {1});
+
+    EXPECT_THROW(
+        search_server.AddDocuments(std::execution::par, {
+            {2, "curly hair", DocumentStatus::ACTUAL, {1}},
+            {3, "nasty \x12rat", DocumentStatus::ACTUAL, {1}},
+        }),
+        std::invalid_argument
+    );
+    EXPECT_THROW(
+        search_server.AddDocuments({
+            {2, "curly hair", DocumentStatus::ACTUAL, {1}},
+            {2, "nasty rat", DocumentStatus::ACTUAL, {1}},
+        }),
+        std::invalid_argument
+    );
+    EXPECT_THROW(
+        search_server.AddDocuments({{1, "curly hair", DocumentStatus::ACTUAL, {1}}}),
+        std::invalid_argument
+    );
+
+    ASSERT_EQ(1, search_server.GetDocumentCount())
+        << "AddDocuments() mustn't add any document of an invalid batch";
+}
+
 TEST(SearchServer, RemoveDocument) {
     SearchServer search_server;
     AddDocuments(search_server);
@@ -80,6 +159,152 @@ TEST(SearchServer, RemoveDocument) {
     ASSERT_EQ(last_id - 1, search_server.GetDocumentCount());
 }
 
+TEST(SearchServer, AddDocumentAfterRemove) {
+    SearchServer search_server;
+    AddDocuments(search_server);
+
+    for (int id : {1, 10, 11, 12, 13})
+        search_server.RemoveDocument(id);
+    search_server.AddDocument(1, "nasty dog", DocumentStatus::ACTUAL, {1});
+
+    std::vector<int> found_ids;
+    for (const Document& document : search_server.FindTopDocuments("nasty"))
+        found_ids.push_back(document.id);
+
+    ASSERT_EQ(std::vector<int>({1, 14}), found_ids)
+        << "FindTopDocuments() must find a document added again after its removal";
+}
+
+TEST(SearchServer, RemoveMostDocuments) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+
+    for (int id = 1; id <= 10; ++id)
+        search_server.RemoveDocument(id);
+
+    const std::vector<Document> found_docs = search_server.FindTopDocuments("curly hair");
+    ASSERT_EQ(1u, found_docs.size());
+    ASSERT_EQ(14, found_docs[0].id);
+    ASSERT_EQ(2, found_docs[0].rating);
+
+    const auto& [matched_words, status] = search_server.MatchDocument("rat -tail", 13);
+    ASSERT_EQ(std::vector<std::string_view>({"rat"}), matched_words);
+    ASSERT_EQ(DocumentStatus::ACTUAL, status);
+}
+
+TEST(SearchServer, RemoveDocumentParallel) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 100, 1'000);
+
+    SearchServer search_server;
+    for (int id = 0; id < static_cast<int>(texts.size()); ++id)
+        search_server.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {id});
+    SearchServer expected_server = search_server;
+
+    for (int id = 0; id < static_cast<int>(texts.size()); id += 3) {
+        expected_server.RemoveDocument(id);
+        search_server.RemoveDocument(std::execution::par, id);
+    }
+
+    ASSERT_EQ(std::vector<int>(expected_server.begin(), expected_server.end()),
+              std::vector<int>(search_server.begin(), search_server.end()));
+    for (const std::string& query : GenerateQueries(generator, dictionary, 10, 5)) {
+        const auto expected_documents = expected_server.FindTopDocuments(query);
+        const auto found_documents = search_server.FindTopDocuments(std::execution::par, query);
+        ASSERT_EQ(expected_documents.size(), found_documents.size());
+        for (size_t i = 0; i < found_documents.size(); ++i)
+            ASSERT_EQ(expected_documents[i].id, found_documents[i].id);
+    }
+}
+
+TEST(SearchServer, CopyAndMove) {
+    const auto find_ids = [](const SearchServer& search_server) {
+        std::vector<int> found_ids;
+        for (const Document& document : search_server.FindTopDocuments("funny curly rat"))
+            found_ids.push_back(document.id);
+        return found_ids;
+    };
+
+    auto search_server = std::make_unique<SearchServer>("and with"sv);
+    AddDocuments(*search_server);
+    const std::vector<int> expected_ids = find_ids(*search_server);
+    const std::map<std::string_view, double> word_freqs = search_server->GetWordFrequencies(1);
+    const std::map<std::string, double> expected_word_freqs(word_freqs.begin(), word_freqs.end());
+    const auto get_word_freqs = [](const SearchServer& search_server, int document_id) {
+        const std::map<std::string_view, double>& word_freqs = search_server.GetWordFrequencies(document_id);
+        return std::map<std::string, double>(word_freqs.begin(), word_freqs.end());
+    };
+
+    // Copies own their memory, so they outlive the original
+    SearchServer copy(*search_server);
+    search_server->RemoveDocument(1);
+    search_server->AddDocument(100, "curly rat", DocumentStatus::ACTUAL, {9});
+    search_server.reset();
+    ASSERT_EQ(expected_ids, find_ids(copy));
+    ASSERT_EQ(expected_word_freqs, get_word_freqs(copy, 1));
+
+    // Assigned servers keep their own memory too
+    auto source = std::make_unique<SearchServer>(copy);
+    source->GetWordFrequencies(1);
+    SearchServer assigned("curly"sv);
+    assigned.AddDocument(200, "funny rat", DocumentStatus::ACTUAL, {1});
+    assigned.GetWordFrequencies(200);
+    assigned = *source;
+    SearchServer move_assigned;
+    move_assigned = std::move(*source);
+    source.reset();
+    for (const SearchServer* server : {&assigned, &move_assigned}) {
+        ASSERT_EQ(expected_ids, find_ids(*server));
+        ASSERT_EQ(expected_word_freqs, get_word_freqs(*server, 1));
+        ASSERT_TRUE(get_word_freqs(*server, 200).empty());
+    }
+    assigned = assigned;
+    ASSERT_EQ(expected_ids, find_ids(assigned));
+
+    // Moved containers keep the memory of the moved server
+    SearchServer moved(std::move(copy));
+    moved.AddDocument(100, "funny curly rat", DocumentStatus::ACTUAL, {9});
+    moved.RemoveDocument(1);
+    ASSERT_EQ(100, find_ids(moved).front());
+    ASSERT_EQ(moved.GetDocumentCount(), SearchServer(moved).GetDocumentCount());
+}
+
+TEST(SearchServer, RemoveDocuments) {
+    SearchServer expected_server("and with"sv);
+    AddDocuments(expected_server);
+    for (int id : {3, 5, 8, 9, 10, 12})
+        expected_server.RemoveDocument(id);
+
+    const auto find_ids = [](const SearchServer& search_server) {
+        std::vector<int> found_ids;
+        for (const Document& document : search_server.FindTopDocuments("funny curly rat"))
+            found_ids.push_back(document.id);
+        return found_ids;
+    };
+
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    search_server.RemoveDocuments({12, 3, 1000, 5, 8, 9, 10, 3});
+
+    ASSERT_EQ(std::vector<int>(expected_server.begin(), expected_server.end()),
+              std::vector<int>(search_server.begin(), search_server.end()))
+        << "RemoveDocuments() must keep the order of the remaining documents";
+    for (int id : search_server)
+        ASSERT_EQ(expected_server.GetWordFrequencies(id), search_server.GetWordFrequencies(id));
+    ASSERT_EQ(find_ids(expected_server), find_ids(search_server));
+    ASSERT_TRUE(search_server.FindTopDocuments("sunglasses").empty())
+        << "RemoveDocuments() must drop words left without documents";
+
+    SearchServer parallel_server("and with"sv);
+    AddDocuments(parallel_server);
+    parallel_server.RemoveDocuments(std::execution::par, {3, 5, 8, 9, 10, 12});
+    ASSERT_EQ(find_ids(expected_server), find_ids(parallel_server));
+
+    parallel_server.AddDocument(5, "bird round sunglasses", DocumentStatus::ACTUAL, {1});
+    ASSERT_EQ(1u, parallel_server.FindTopDocuments("sunglasses").size());
+}
+
 TEST(SearchServer, RemoveDocumentByNonExistedId) {
     SearchServer search_server;
     AddDocuments(search_server);
@@ -98,6 +323,33 @@ TEST(SearchServer, ParseQuery) {
         << "ParseQuery() must exclude a document with a minus word from the result";
 }
 
+TEST(SearchServer, ParseQueryParallel) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+
+    const auto& [matched_words, _] = search_server.MatchDocument(
+        std::execution::par, "rat  rat funny -tail funny with", 1
+    );
+    ASSERT_EQ(std::vector<std::string_view>({"funny", "rat"}), matched_words)
+        << "ParseQuery() must return sorted unique words without stop words";
+
+    EXPECT_THROW(search_server.FindTopDocuments(std::execution::par, "curly --hair"),
+                 std::invalid_argument);
+    EXPECT_THROW(search_server.MatchDocument(std::execution::par, "curly -", 1),
+                 std::invalid_argument);
+
+    std::string long_query;
+    for (int i = 0; i < 1000; ++i)
+        long_query += " funny -tail"s + (i % 2 ? " rat" : " curly");
+
+    std::vector<int> expected_ids, found_ids;
+    for (const Document& document : search_server.FindTopDocuments("curly funny rat -tail"))
+        expected_ids.push_back(document.id);
+    for (const Document& document : search_server.FindTopDocuments(std::execution::par, long_query))
+        found_ids.push_back(document.id);
+    ASSERT_EQ(expected_ids, found_ids);
+}
+
 TEST(SearchServer, MatchDocument) {
     SearchServer search_server;
     AddDocuments(search_server);
@@ -127,6 +379,36 @@ TEST(SearchServer, MatchDocumentByMinusWord) {
         << "if matching at least one minus word";
 }
 
+TEST(SearchServer, MatchDocumentIntoBuffer) {
+    SearchServer search_server;
+    AddDocuments(search_server);
+
+    std::vector<std::string_view> matched_words{"stale"};
+    for (int id : search_server) {
+        const auto& [expected_words, expected_status] = search_server.MatchDocument(
+            "funny pet nasty rat -tail", id
+        );
+        const DocumentStatus status = search_server.MatchDocument(
+            "funny pet nasty rat -tail", id, matched_words
+        );
+        ASSERT_EQ(expected_words, matched_words);
+        ASSERT_EQ(expected_status, status);
+    }
+}
+
+TEST(SearchServer, MatchDocumentParallel) {
+    SearchServer search_server;
+    AddDocuments(search_server);
+
+    for (const std::string_view query : {"funny pet nasty rat curly -tail"sv, "rat -Borya"sv}) {
+        for (int id : search_server) {
+            ASSERT_EQ(search_server.MatchDocument(query, id),
+                      search_server.MatchDocument(std::execution::par, query, id))
+                << "MatchDocument() must match the same words for every execution policy";
+        }
+    }
+}
+
 TEST(SearchServer, MatchDocumentByNoneMatchingWords) {
     SearchServer search_server;
     AddDocuments(search_server);
@@ -151,6 +433,62 @@ TEST(SearchServer, Sorting) {
         << "FindTopDocuments() must sort found documents by decrease of relevance";
 }
 
+TEST(SearchServer, FindTopDocumentsByMaxDocumentCount) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+
+    const std::string_view query = "funny nasty curly rat round";
+    const std::vector<Document> all_docs = search_server.FindTopDocuments(
+        query, DocumentStatus::ACTUAL, 100
+    );
+    ASSERT_EQ(12u, all_docs.size());
+
+    for (size_t max_count : {0u, 1u, 5u, 8u}) {
+        std::vector<int> expected_ids;
+        for (size_t i = 0; i < max_count; ++i)
+            expected_ids.push_back(all_docs[i].id);
+
+        for (const auto& found_docs : {
+                search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, max_count),
+                search_server.FindTopDocuments(std::execution::par, query,
+                                               DocumentStatus::ACTUAL, max_count)}) {
+            std::vector<int> found_ids;
+            for (const Document& document : found_docs)
+                found_ids.push_back(document.id);
+            ASSERT_EQ(expected_ids, found_ids)
+                << "FindTopDocuments() must return the best " << max_count << " documents";
+        }
+    }
+
+    const size_t unbounded_count = std::numeric_limits<size_t>::max();
+    for (const auto& found_docs : {
+            search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, unbounded_count),
+            search_server.FindTopDocuments(std::execution::par, query,
+                                           DocumentStatus::ACTUAL, unbounded_count)}) {
+        ASSERT_EQ(all_docs.size(), found_docs.size())
+            << "FindTopDocuments() must return every document found when the count is huge";
+    }
+}
+
+TEST(SearchServer, FindTopDocumentsParallel) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 100, 5);
+    const auto texts = GenerateQueries(generator, dictionary, 100'000, 5);
+
+    SearchServer search_server;
+    for (size_t i = 0; i < texts.size(); ++i)
+        search_server.AddDocument(i, texts[i], DocumentStatus::ACTUAL, {static_cast<int>(i % 7)});
+
+    for (const std::string& query : GenerateQueries(generator, dictionary, 10, 5)) {
+        const auto expected_docs = search_server.FindTopDocuments(query);
+        const auto found_docs = search_server.FindTopDocuments(std::execution::par, query);
+
+        ASSERT_EQ(expected_docs.size(), found_docs.size()) << query;
+        for (size_t i = 0; i < expected_docs.size(); ++i)
+            ASSERT_EQ(expected_docs[i].id, found_docs[i].id) << query;
+    }
+}
+
 TEST(SearchServer, FindTopDocumentsByUserPredicate) {
     SearchServer search_server;
     AddDocuments(search_server);
@@ -207,6 +545,641 @@ TEST(SearchServer, GetWordFrequencies) {
     );
 }
 
+TEST(SearchServer, GetWordFrequenciesAfterCorpusChange) {
+    SearchServer search_server("fat"sv);
+    AddDocuments(search_server);
+    search_server.GetWordFrequencies(7);
+
+    search_server.AddDocument(15, "snake", DocumentStatus::ACTUAL, {0});
+    ASSERT_DOUBLE_EQ(log(15.0/3.0), search_server.GetWordFrequencies(7).at("snake"))
+        << "GetWordFrequencies() must follow documents added after the previous call";
+
+    search_server.RemoveDocument(6);
+    ASSERT_DOUBLE_EQ(log(14.0/2.0), search_server.GetWordFrequencies(7).at("snake"))
+        << "GetWordFrequencies() must follow documents removed after the previous call";
+}
+
+TEST(SearchServer, GetWordFrequenciesParallel) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    const SearchServer expected_server(search_server);
+
+    // Concurrent readers of a const server fill the same cache entries
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&search_server, &expected_server] {
+            for (const int document_id : expected_server)
+                EXPECT_EQ(expected_server.GetWordFrequencies(document_id),
+                          search_server.GetWordFrequencies(document_id));
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+/* -------------------------- ShardedSearchServer -------------------------- */
+
+TEST(ShardedSearchServer, FindTopDocuments) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 5'000, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 5);
+
+    std::vector<RawDocument> documents;
+    for (int id = 0; id < static_cast<int>(texts.size()); ++id)
+        documents.push_back({id, texts[id], DocumentStatus::ACTUAL, {id % 7}});
+
+    SearchServer search_server(dictionary[0]);
+    search_server.AddDocuments(documents);
+    ShardedSearchServer sharded_server(4, dictionary[0]);
+    sharded_server.AddDocuments(std::execution::par, documents);
+
+    std::vector<int> removed_ids;
+    for (int id = 0; id < static_cast<int>(texts.size()); id += 5)
+        removed_ids.push_back(id);
+    search_server.RemoveDocuments(removed_ids);
+    sharded_server.RemoveDocuments(std::execution::par, removed_ids);
+    search_server.RemoveDocument(1);
+    sharded_server.RemoveDocument(1);
+    ASSERT_EQ(search_server.GetDocumentCount(), sharded_server.GetDocumentCount());
+
+    for (const std::string& query : queries) {
+        const auto expected_documents = search_server.FindTopDocuments(query);
+        for (const auto& found_documents : {sharded_server.FindTopDocuments(query),
+                                            sharded_server.FindTopDocuments(std::execution::par, query)}) {
+            ASSERT_EQ(expected_documents.size(), found_documents.size());
+            for (size_t i = 0; i < found_documents.size(); ++i) {
+                ASSERT_EQ(expected_documents[i].id, found_documents[i].id)
+                    << "ShardedSearchServer must rank documents as a single SearchServer";
+                ASSERT_DOUBLE_EQ(expected_documents[i].relevance, found_documents[i].relevance);
+            }
+        }
+        ASSERT_EQ(search_server.MatchDocument(query, 2), sharded_server.MatchDocument(query, 2));
+    }
+}
+
+TEST(ShardedSearchServer, AddDocumentsByInvalidBatch) {
+    ShardedSearchServer sharded_server(3, "and with"sv);
+    sharded_server.AddDocument(1, "funny pet", DocumentStatus::ACTUAL, {1});
+
+    EXPECT_THROW(sharded_server.AddDocuments(std::execution::par, {
+                     {2, "curly hair", DocumentStatus::ACTUAL, {1}},
+                     {3, "nasty \x12rat", DocumentStatus::ACTUAL, {1}},
+                 }),
+                 std::invalid_argument);
+    EXPECT_THROW(sharded_server.AddDocuments({{4, "curly hair", DocumentStatus::ACTUAL, {1}},
+                                              {1, "curly hair", DocumentStatus::ACTUAL, {1}}}),
+                 std::invalid_argument);
+    EXPECT_THROW(ShardedSearchServer(0), std::invalid_argument);
+
+    ASSERT_EQ(1, sharded_server.GetDocumentCount())
+        << "AddDocuments() mustn't add any document of an invalid batch";
+}
+
+
+/* ------------------------- SnapshotSearchServer -------------------------- */
+
+TEST(SnapshotSearchServer, FindTopDocuments) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 3'000, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 5);
+
+    SearchServer search_server(dictionary[0]);
+    SnapshotSearchServer snapshot_server(dictionary[0]);
+    for (int first_id = 0; first_id < static_cast<int>(texts.size()); first_id += 1'000) {
+        std::vector<RawDocument> documents;
+        for (int id = first_id; id < first_id + 1'000; ++id)
+            documents.push_back({id, texts[id], DocumentStatus::ACTUAL, {id % 7}});
+        search_server.AddDocuments(documents);
+        snapshot_server.AddDocuments(std::execution::par, documents);
+    }
+
+    std::vector<int> removed_ids;
+    for (int id = 0; id < static_cast<int>(texts.size()); id += 5)
+        removed_ids.push_back(id);
+    search_server.RemoveDocuments(removed_ids);
+    snapshot_server.RemoveDocuments(removed_ids);
+    search_server.RemoveDocument(1);
+    snapshot_server.RemoveDocument(1);
+    search_server.AddDocument(0, texts[1], DocumentStatus::ACTUAL, {1});
+    snapshot_server.AddDocument(0, texts[1], DocumentStatus::ACTUAL, {1});
+    ASSERT_EQ(search_server.GetDocumentCount(), snapshot_server.GetDocumentCount());
+    snapshot_server.WaitForMerges();
+    ASSERT_EQ(4u, snapshot_server.GetSnapshot()->GetSegmentCount());
+
+    for (const std::string& query : queries) {
+        const auto expected_documents = search_server.FindTopDocuments(query);
+        for (const auto& found_documents : {snapshot_server.FindTopDocuments(query),
+                                            snapshot_server.FindTopDocuments(std::execution::par, query)}) {
+            ASSERT_EQ(expected_documents.size(), found_documents.size());
+            for (size_t i = 0; i < found_documents.size(); ++i) {
+                ASSERT_EQ(expected_documents[i].id, found_documents[i].id)
+                    << "SnapshotSearchServer must rank documents as a single SearchServer";
+                ASSERT_DOUBLE_EQ(expected_documents[i].relevance, found_documents[i].relevance);
+            }
+        }
+        ASSERT_EQ(search_server.MatchDocument(query, 0), snapshot_server.MatchDocument(query, 0));
+    }
+    EXPECT_THROW(snapshot_server.MatchDocument("query", 1), std::out_of_range);
+    EXPECT_THROW(snapshot_server.AddDocument(2, "used id", DocumentStatus::ACTUAL, {1}),
+                 std::invalid_argument);
+}
+
+TEST(SnapshotSearchServer, GetSnapshot) {
+    SnapshotSearchServer snapshot_server("and with"sv);
+    snapshot_server.AddDocument(1, "funny pet and nasty rat", DocumentStatus::ACTUAL, {7});
+
+    const auto snapshot = snapshot_server.GetSnapshot();
+    snapshot_server.AddDocument(2, "funny pet with curly hair", DocumentStatus::ACTUAL, {4});
+    snapshot_server.RemoveDocument(1);
+
+    ASSERT_EQ(1, snapshot->GetDocumentCount());
+    ASSERT_EQ(1u, snapshot->FindTopDocuments("funny").size())
+        << "A snapshot mustn't change after it was taken";
+    ASSERT_EQ(2, snapshot_server.FindTopDocuments("funny").at(0).id);
+    snapshot_server.WaitForMerges();
+    ASSERT_EQ(1u, snapshot_server.GetSnapshot()->GetSegmentCount())
+        << "A segment without live documents must be dropped";
+}
+
+TEST(SnapshotSearchServer, FindTopDocumentsWhileWriting) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 100, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 1'000, 10);
+
+    SearchServer search_server;
+    SnapshotSearchServer snapshot_server;
+    std::atomic_bool is_writing = true;
+    std::thread writer([&] {
+        for (int id = 0; id < static_cast<int>(texts.size()); ++id) {
+            search_server.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {1});
+            snapshot_server.AddDocument(id, texts[id], DocumentStatus::ACTUAL, {1});
+            if (id % 3 == 0) {
+                search_server.RemoveDocument(id / 2);
+                snapshot_server.RemoveDocument(id / 2);
+            }
+        }
+        is_writing = false;
+    });
+
+    while (is_writing) {
+        const auto snapshot = snapshot_server.GetSnapshot();
+        for (const Document& document : snapshot->FindTopDocuments(dictionary[1]))
+            ASSERT_TRUE(snapshot->HasDocument(document.id));
+    }
+    writer.join();
+    snapshot_server.WaitForMerges();
+
+    ASSERT_EQ(search_server.GetDocumentCount(), snapshot_server.GetDocumentCount());
+    ASSERT_LT(snapshot_server.GetSnapshot()->GetSegmentCount(), 20u)
+        << "Segments of single documents must be merged in the background";
+    for (const std::string& word : dictionary) {
+        const auto expected_documents = search_server.FindTopDocuments(word);
+        const auto found_documents = snapshot_server.FindTopDocuments(word);
+        ASSERT_EQ(expected_documents.size(), found_documents.size());
+        for (size_t i = 0; i < found_documents.size(); ++i) {
+            ASSERT_EQ(expected_documents[i].id, found_documents[i].id);
+            ASSERT_DOUBLE_EQ(expected_documents[i].relevance, found_documents[i].relevance);
+        }
+    }
+}
+
+
+/* --------------------------- MappedSearchServer -------------------------- */
+
+TEST(MappedSearchServer, SaveAndOpen) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 5'000, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 5);
+
+    SearchServer search_server(dictionary[0] + ' ' + dictionary[1]);
+    for (int id = 0; id < static_cast<int>(texts.size()); ++id)
+        search_server.AddDocument((id*7919) % 5'003, texts[id],
+                                  static_cast<DocumentStatus>(id % 3), {id % 7});
+    std::vector<int> removed_ids;
+    for (int id = 0; id < 5'003; id += 3)
+        removed_ids.push_back(id);
+    search_server.RemoveDocuments(removed_ids);
+
+    const std::string path = std::filesystem::temp_directory_path() / "gtest-mapped_search_server.index";
+    search_server.Save(path);
+    const MappedSearchServer mapped_server = MappedSearchServer::Open(path);
+    std::remove(path.c_str());
+
+    ASSERT_TRUE(mapped_server.VerifyChecksum());
+    ASSERT_EQ(search_server.GetDocumentCount(), mapped_server.GetDocumentCount());
+
+    const auto is_even = [](int document_id, DocumentStatus, int) {
+        return document_id % 2 == 0;
+    };
+    for (const std::string& raw_query : queries) {
+        const std::string query = raw_query + " -" + dictionary[2];
+        for (const auto& [expected_documents, found_documents] : {
+                 std::pair(search_server.FindTopDocuments(query),
+                           mapped_server.FindTopDocuments(query)),
+                 std::pair(search_server.FindTopDocuments(query, DocumentStatus::BANNED),
+                           mapped_server.FindTopDocuments(query, DocumentStatus::BANNED)),
+                 std::pair(search_server.FindTopDocuments(query, is_even),
+                           mapped_server.FindTopDocuments(query, is_even))}) {
+            ASSERT_EQ(expected_documents.size(), found_documents.size());
+            for (size_t i = 0; i < found_documents.size(); ++i) {
+                ASSERT_EQ(expected_documents[i].id, found_documents[i].id)
+                    << "MappedSearchServer must rank documents as the saved SearchServer";
+                ASSERT_DOUBLE_EQ(expected_documents[i].relevance, found_documents[i].relevance);
+                ASSERT_EQ(expected_documents[i].rating, found_documents[i].rating);
+            }
+        }
+        ASSERT_EQ(search_server.MatchDocument(query, 1), mapped_server.MatchDocument(query, 1));
+    }
+
+    ASSERT_THROW(mapped_server.MatchDocument(dictionary[3], 3), std::out_of_range);
+    ASSERT_THROW(mapped_server.FindTopDocuments("--"sv), std::invalid_argument);
+}
+
+TEST(MappedSearchServer, OpenInvalidFile) {
+    const std::string path = std::filesystem::temp_directory_path() / "gtest-mapped_search_server.index";
+    std::remove(path.c_str());
+    ASSERT_THROW(MappedSearchServer::Open(path), std::system_error);
+
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    search_server.Save(path);
+
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const auto write_file = [&path](const std::string& data) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+    };
+
+    const bool skip_checksum = true;
+    std::string corrupted_data = data;
+    corrupted_data[data.size() - 1] ^= 1;
+    write_file(corrupted_data);
+    ASSERT_THROW(MappedSearchServer::Open(path), std::invalid_argument);
+    ASSERT_FALSE(MappedSearchServer::Open(path, skip_checksum).VerifyChecksum());
+
+    // Offsets are checked even when the checksum is skipped
+    IndexFileHeader header;
+    std::copy_n(data.data(), sizeof(header), reinterpret_cast<char*>(&header));
+    const IndexFileLayout layout = ComputeIndexFileLayout(header);
+    for (const size_t offsets : {layout.term_word_offsets,
+                                 layout.term_posting_offsets,
+                                 layout.document_term_offsets}) {
+        for (const size_t byte : {offsets, offsets + sizeof(uint64_t) + 7}) {
+            corrupted_data = data;
+            corrupted_data[byte] ^= 0x40;
+            write_file(corrupted_data);
+            ASSERT_THROW(MappedSearchServer::Open(path, skip_checksum), std::invalid_argument)
+                << "MappedSearchServer must reject offsets out of their sections";
+            ASSERT_THROW(MappedSearchServer::Open(path), std::invalid_argument);
+        }
+    }
+
+    // A header of huge counts must not make the layout overflow
+    corrupted_data = data;
+    header.posting_count = UINT64_MAX/2;
+    std::copy_n(reinterpret_cast<const char*>(&header), sizeof(header), corrupted_data.data());
+    write_file(corrupted_data);
+    ASSERT_THROW(MappedSearchServer::Open(path, skip_checksum), std::invalid_argument);
+
+    write_file(data.substr(0, data.size() - 8));
+    ASSERT_THROW(MappedSearchServer::Open(path), std::invalid_argument);
+
+    write_file("not an index file at all, but long enough for a header to be read...");
+    ASSERT_THROW(MappedSearchServer::Open(path), std::invalid_argument);
+
+    std::remove(path.c_str());
+}
+
+/* ----------------------------- DocumentLoader ---------------------------- */
+
+TEST(DocumentLoader, Load) {
+    std::mt19937 generator;
+    const auto dictionary = GenerateDictionary(generator, 1'000, 10);
+    const auto texts = GenerateQueries(generator, dictionary, 2'000, 20);
+    const auto queries = GenerateQueries(generator, dictionary, 100, 5);
+
+    SearchServer expected_server(dictionary[0]);
+    std::ostringstream records;
+    for (int id = 0; id < static_cast<int>(texts.size()); ++id) {
+        const DocumentStatus status = static_cast<DocumentStatus>(id % 4);
+        expected_server.AddDocument(id, texts[id], status, {id % 5, -id % 7});
+        records << id << '\t' << id % 4 << '\t' << id % 5 << ' ' << -id % 7
+                << '\t' << texts[id] << (id % 2 ? "\n" : "\r\n");
+        if (id % 100 == 0)
+            records << '\n';
+    }
+
+    SearchServer search_server(dictionary[0]);
+    // Small chunks cut records and fill the queues
+    DocumentLoader loader(search_server, {100, 2});
+    std::istringstream in(records.str());
+    const DocumentLoader::Stats stats = loader.Load(in);
+
+    ASSERT_EQ(texts.size(), stats.document_count);
+    ASSERT_EQ(expected_server.GetDocumentCount(), search_server.GetDocumentCount());
+    ASSERT_GT(stats.chunk_queue.push_count, 0u);
+    ASSERT_LE(stats.chunk_queue.max_depth, 2u);
+    ASSERT_LE(stats.batch_queue.max_depth, 2u);
+    for (const std::string& query : queries) {
+        for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+            const auto expected_documents = expected_server.FindTopDocuments(query, status);
+            const auto found_documents = search_server.FindTopDocuments(query, status);
+            ASSERT_EQ(expected_documents.size(), found_documents.size());
+            for (size_t i = 0; i < found_documents.size(); ++i) {
+                ASSERT_EQ(expected_documents[i].id, found_documents[i].id);
+                ASSERT_DOUBLE_EQ(expected_documents[i].relevance, found_documents[i].relevance);
+                ASSERT_EQ(expected_documents[i].rating, found_documents[i].rating);
+            }
+        }
+    }
+}
+
+TEST(DocumentLoader, LoadInvalidRecords) {
+    const RawDocument document = DocumentLoader::ParseRecord("5\t2\t1 -2 3\tcurly\tdog"sv);
+    ASSERT_EQ(5, document.id);
+    ASSERT_EQ(DocumentStatus::BANNED, document.status);
+    ASSERT_EQ(std::vector<int>({1, -2, 3}), document.ratings);
+    ASSERT_EQ("curly\tdog"sv, document.text);
+
+    ASSERT_THROW(DocumentLoader::ParseRecord("5\t2\tcurly dog"sv), std::invalid_argument);
+    ASSERT_THROW(DocumentLoader::ParseRecord("5\t7\t\tcurly dog"sv), std::invalid_argument);
+    ASSERT_THROW(DocumentLoader::ParseRecord("x\t0\t\tcurly dog"sv), std::invalid_argument);
+    ASSERT_THROW(DocumentLoader::ParseRecord("5\t0\t1x\tcurly dog"sv), std::invalid_argument);
+
+    for (const std::string& records : {"1\t0\t\tfunny pet\n1\t0\t\tcurly dog\n"s,
+                                       "1\t0\t\tfunny pet\n2\t0\t\tcurly \x12 dog\n"s,
+                                       "1\t0\t\tfunny pet\n2\t0\n"s}) {
+        SearchServer search_server;
+        std::istringstream in(records);
+        ASSERT_THROW(DocumentLoader(search_server).Load(in), std::invalid_argument);
+    }
+
+    SearchServer search_server;
+    ASSERT_THROW(DocumentLoader(search_server).Load("/nonexistent/documents.tsv"s),
+                 std::system_error);
+}
+
+TEST(BoundedQueue, PushAndPop) {
+    BoundedQueue<int> queue(2);
+    std::thread producer([&queue] {
+        for (int i = 0; i < 100; ++i)
+            queue.Push(i);
+        queue.Close();
+    });
+
+    std::vector<int> values;
+    while (std::optional<int> value = queue.Pop())
+        values.push_back(*value);
+    producer.join();
+
+    std::vector<int> expected_values(100);
+    std::iota(expected_values.begin(), expected_values.end(), 0);
+    ASSERT_EQ(expected_values, values);
+    ASSERT_EQ(100u, queue.GetStats().push_count);
+    ASSERT_LE(queue.GetStats().max_depth, 2u);
+    ASSERT_FALSE(queue.Push(100));
+    ASSERT_THROW(BoundedQueue<int>(0), std::invalid_argument);
+}
+
+/* ------------------------------ PostingList ------------------------------ */
+
+void ExpectPostings(const std::map<int, double>& expected, const PostingList& postings) {
+    std::map<int, double> found;
+    postings.ForEach([&found](int ordinal, double term_freq) {
+        EXPECT_TRUE(found.emplace(ordinal, term_freq).second);
+    });
+    EXPECT_EQ(found, expected);
+    EXPECT_EQ(postings.size(), expected.size());
+
+    for (const auto& [first, last] : {std::pair{0, 100}, std::pair{1'000, 7'777}, std::pair{5'000, 5'001}}) {
+        std::map<int, double> found_range;
+        postings.ForEach(first, last, [&found_range](int ordinal, double term_freq) {
+            found_range.emplace(ordinal, term_freq);
+        });
+        const std::map<int, double> expected_range(expected.lower_bound(first),
+                                                   expected.lower_bound(last));
+        EXPECT_EQ(found_range, expected_range);
+    }
+}
+
+TEST(PostingList, AddAndErase) {
+    std::mt19937 generator;
+    std::map<int, double> expected;
+    PostingList postings;
+
+    // Gaps of different widths are packed into blocks of different widths
+    int ordinal = 0;
+    for (int i = 0; i < 1'000; ++i) {
+        ordinal += std::uniform_int_distribution(1, i % 300 < 150 ? 3 : 40)(generator);
+        const double term_freq = 1.0/std::uniform_int_distribution(1, 20)(generator);
+        postings.Add(ordinal, term_freq);
+        expected[ordinal] = term_freq;
+    }
+    ExpectPostings(expected, postings);
+
+    for (int i = 0; i < 300; ++i) {
+        const int removed = std::uniform_int_distribution(0, ordinal)(generator);
+        EXPECT_EQ(postings.Erase(removed), expected.erase(removed) == 1);
+        EXPECT_FALSE(postings.Contains(removed));
+    }
+    ExpectPostings(expected, postings);
+
+    std::vector<int> removed_ordinals;
+    for (const auto& [expected_ordinal, term_freq] : expected)
+        if (removed_ordinals.size()*3 <= expected.size() && expected_ordinal % 3 == 0)
+            removed_ordinals.push_back(expected_ordinal);
+    removed_ordinals.push_back(ordinal + 1);
+    EXPECT_EQ(postings.Erase(removed_ordinals.begin(), removed_ordinals.end()),
+              removed_ordinals.size() - 1);
+    for (const int removed : removed_ordinals)
+        expected.erase(removed);
+    ExpectPostings(expected, postings);
+
+    // Ordinals below the last one are inserted or revived
+    for (const int added : {0, 2, removed_ordinals[1], ordinal/2, ordinal + 10}) {
+        postings.Add(added, 0.5);
+        expected[added] = 0.5;
+        EXPECT_TRUE(postings.Contains(added));
+    }
+    ExpectPostings(expected, postings);
+}
+
+TEST(PostingList, EraseMostPostings) {
+    std::map<int, double> expected;
+    PostingList postings;
+    for (int ordinal = 0; ordinal < 1'000; ++ordinal) {
+        postings.Add(ordinal*7, 1.0/(ordinal % 13 + 1));
+        expected[ordinal*7] = 1.0/(ordinal % 13 + 1);
+    }
+
+    for (int ordinal = 0; ordinal < 7'000; ordinal += 7) {
+        if (ordinal % 10 == 0)
+            continue;
+        ASSERT_TRUE(postings.Erase(ordinal));
+        ASSERT_FALSE(postings.Erase(ordinal));
+        expected.erase(ordinal);
+    }
+    ExpectPostings(expected, postings);
+
+    std::vector<int> new_ordinals(7'000, -1);
+    int new_ordinal = 0;
+    for (const auto& [ordinal, term_freq] : expected)
+        new_ordinals[ordinal] = new_ordinal++;
+    postings.Renumber(new_ordinals);
+
+    std::map<int, double> renumbered;
+    for (const auto& [ordinal, term_freq] : expected)
+        renumbered[new_ordinals[ordinal]] = term_freq;
+    ExpectPostings(renumbered, postings);
+
+    for (const auto& [ordinal, term_freq] : renumbered)
+        postings.Erase(ordinal);
+    EXPECT_TRUE(postings.empty());
+}
+
+/* ---------------------------- QueryResultCache --------------------------- */
+
+// Cached results are copies of found ones, so their ids are enough to compare
+std::vector<int> GetDocumentIds(const std::vector<Document>& documents) {
+    std::vector<int> ids;
+    for (const Document& document : documents)
+        ids.push_back(document.id);
+    return ids;
+}
+
+TEST(QueryResultCache, FindTopDocuments) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 1024);
+
+    for (const std::string_view query : {"nasty rat -not"sv, "curly hair"sv, "snake"sv, "mouse -round"sv}) {
+        for (const DocumentStatus status : {DocumentStatus::ACTUAL, DocumentStatus::BANNED}) {
+            const std::vector<int> expected = GetDocumentIds(search_server.FindTopDocuments(query, status));
+            EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments(query, status)), expected);
+            EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments(query, status)), expected);
+        }
+    }
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("funny pet", DocumentStatus::ACTUAL, 2)),
+              GetDocumentIds(search_server.FindTopDocuments("funny pet", DocumentStatus::ACTUAL, 2)));
+
+    const QueryResultCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count, 8u);
+    EXPECT_EQ(stats.miss_count, 9u);
+    EXPECT_EQ(stats.size, 9u);
+}
+
+TEST(QueryResultCache, CanonicalQuery) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 1024);
+
+    const std::vector<int> expected = GetDocumentIds(cache.FindTopDocuments("nasty rat -not"));
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("rat  nasty rat -not")), expected);
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("-not rat and nasty -not")), expected);
+    cache.FindTopDocuments("nasty rat not");
+    cache.FindTopDocuments("nasty rat -not", DocumentStatus::IRRELEVANT);
+
+    const QueryResultCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count, 2u);
+    EXPECT_EQ(stats.miss_count, 3u);
+}
+
+TEST(QueryResultCache, Invalidation) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 1024);
+
+    const std::vector<int> found_before = GetDocumentIds(cache.FindTopDocuments("sunglasses"));
+    ASSERT_EQ(found_before.size(), 1u);
+    cache.FindTopDocuments("snake");
+
+    search_server.AddDocument(20, "cat in sunglasses", DocumentStatus::ACTUAL, {1});
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("sunglasses")), std::vector<int>({20, 5}));
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("sunglasses")), std::vector<int>({20, 5}));
+
+    search_server.RemoveDocument(20);
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("sunglasses")), found_before);
+
+    // Removing an unknown document doesn't change the index
+    search_server.RemoveDocument(100);
+    EXPECT_EQ(GetDocumentIds(cache.FindTopDocuments("sunglasses")), found_before);
+
+    const QueryResultCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count, 2u);
+    EXPECT_EQ(stats.miss_count, 4u);
+    EXPECT_EQ(stats.eviction_count, 0u);
+    EXPECT_GE(stats.invalidation_count, 2u);
+}
+
+TEST(QueryResultCache, LeastRecentlyUsedEviction) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 2, 1);
+
+    cache.FindTopDocuments("rat");
+    cache.FindTopDocuments("pet");
+    cache.FindTopDocuments("rat");
+    cache.FindTopDocuments("snake");
+    cache.FindTopDocuments("rat");
+    cache.FindTopDocuments("pet");
+    cache.FindTopDocuments("rat");
+
+    const QueryResultCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count, 3u);
+    EXPECT_EQ(stats.miss_count, 4u);
+    EXPECT_EQ(stats.eviction_count, 2u);
+    EXPECT_EQ(stats.size, 2u);
+}
+
+TEST(QueryResultCache, InvalidArguments) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+
+    EXPECT_THROW(QueryResultCache(search_server, 0), std::invalid_argument);
+    EXPECT_THROW(QueryResultCache(search_server, 16, 0), std::invalid_argument);
+
+    QueryResultCache cache(search_server, 1024);
+    EXPECT_THROW(cache.FindTopDocuments("rat --pet"), std::invalid_argument);
+    EXPECT_THROW(cache.FindTopDocuments("rat -"), std::invalid_argument);
+    EXPECT_THROW(cache.FindTopDocuments("r\x12 at"), std::invalid_argument);
+    EXPECT_EQ(cache.GetStats().miss_count, 0u);
+}
+
+TEST(QueryResultCache, ParallelQueries) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 4, 2);
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 200; ++i)
+        for (const std::string& query : {"nasty rat -not"s, "curly hair"s, "funny pet"s,
+                                         "round"s, "snake -long"s, "very funny"s})
+            queries.push_back(query);
+
+    std::vector<std::vector<int>> found_ids(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < found_ids.size(); ++i)
+        threads.emplace_back([&, i] {
+            found_ids[i] = GetDocumentIds(ProcessQueriesJoined(cache, queries));
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const std::vector<int> expected = GetDocumentIds(ProcessQueriesJoined(search_server, queries));
+    for (const std::vector<int>& ids : found_ids)
+        EXPECT_EQ(ids, expected);
+
+    const QueryResultCache::Stats stats = cache.GetStats();
+    EXPECT_EQ(stats.hit_count + stats.miss_count, found_ids.size()*queries.size());
+    EXPECT_LE(stats.size, 4u);
+}
+
 /* ---------------------------- RemoveDuplicates --------------------------- */
 
 TEST(RemoveDuplicates, RemoveDuplicates) {
@@ -225,6 +1198,46 @@ TEST(RemoveDuplicates, RemoveDuplicates) {
         << "Duplicated documents must be excluded from the search server";
 }
 
+TEST(RemoveDuplicates, RemoveDuplicatesParallel) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    // Same words as documents 3 and 1, the first of which must be kept
+    search_server.AddDocument(0, "ball round mouse stily white", DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(15, "rat nasty pet funny", DocumentStatus::ACTUAL, {1});
+
+    ASSERT_EQ(std::vector<int>({8, 9, 10, 12, 0, 15}), FindDuplicates(search_server))
+        << "FindDuplicates() must keep the first document of every set of words";
+    ASSERT_EQ(std::vector<int>({8, 9, 10, 12, 0, 15}),
+              RemoveDuplicates(std::execution::par, search_server))
+        << "RemoveDuplicates() must return the ids of the removed documents";
+    ASSERT_EQ(10, search_server.GetDocumentCount());
+    ASSERT_TRUE(FindDuplicates(std::execution::par, search_server).empty());
+}
+
+TEST(RemoveDuplicates, RemoveNearDuplicates) {
+    SearchServer search_server("and with"sv);
+    AddDocuments(search_server);
+    const std::string text = "one two three four five six seven eight nine ten";
+    search_server.AddDocument(20, text, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(21, text + " eleven", DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(22, "one two three four five eleven twelve", DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(23, "two three four five six seven eight nine ten", DocumentStatus::ACTUAL, {1});
+
+    const std::vector<int> expected_ids = {8, 9, 10, 12, 21, 23};
+    ASSERT_EQ(expected_ids, FindNearDuplicates(search_server))
+        << "FindNearDuplicates() must find documents similar to an earlier kept document";
+    ASSERT_EQ(expected_ids, FindNearDuplicates(std::execution::par, search_server));
+    ASSERT_EQ(std::vector<int>({8, 9, 10, 12}),
+              FindNearDuplicates(search_server, {16, 4, 1.0, 32}))
+        << "FindNearDuplicates() with the threshold 1 must find only exact duplicates";
+
+    ASSERT_EQ(expected_ids, RemoveNearDuplicates(std::execution::par, search_server));
+    ASSERT_EQ(12, search_server.GetDocumentCount());
+
+    EXPECT_THROW(FindNearDuplicates(search_server, {0, 4, 0.8, 32}), std::invalid_argument);
+    EXPECT_THROW(FindNearDuplicates(search_server, {16, 4, 1.5, 32}), std::invalid_argument);
+}
+
 
 /* ----------------------------- ProcessQueries ---------------------------- */
 
@@ -325,6 +1338,24 @@ TEST(RequestQueue, RequestQueue) {
     EXPECT_EQ(request_queue.GetNoResultRequests(), 1437);
 }
 
+TEST(RequestQueue, QueryResultCache) {
+    SearchServer search_server;
+    AddDocuments(search_server);
+    QueryResultCache cache(search_server, 16);
+    RequestQueue request_queue(cache);
+
+    for (int i = 0; i < 1439; ++i) {
+        request_queue.AddFindRequest("empty request");
+    }
+    EXPECT_EQ(request_queue.AddFindRequest("sunglasses").size(), 1u);
+    EXPECT_EQ(request_queue.AddFindRequest("round", DocumentStatus::ACTUAL).size(), 3u);
+    request_queue.AddFindRequest("bird", [](int, DocumentStatus, int) { return true; });
+
+    EXPECT_EQ(request_queue.GetNoResultRequests(), 1437);
+    EXPECT_EQ(cache.GetStats().hit_count, 1438u);
+    EXPECT_EQ(cache.GetStats().miss_count, 3u);
+}
+
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+// Replaces the global allocation functions to count heap usage of
+// a benchmark, so it must be included into a single translation unit.
+// Array forms are not replaced, since their defaults call the single
+// object forms replaced here.
+
+namespace memory_usage {
+
+inline std::atomic<size_t> allocated_bytes = 0;
+inline std::atomic<size_t> allocation_count = 0;
+
+inline size_t GetAllocatedBytes() noexcept {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+inline size_t GetAllocationCount() noexcept {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+inline void* Allocate(size_t size, size_t alignment) {
+    size = size ? size : 1;
+    // aligned_alloc requires a size multiple of the alignment
+    void* ptr = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1)/alignment*alignment)
+        : std::malloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+
+    allocated_bytes += malloc_usable_size(ptr);
+    ++allocation_count;
+    return ptr;
+}
+
+inline void Deallocate(void* ptr) noexcept {
+    if (ptr)
+        allocated_bytes -= malloc_usable_size(ptr);
+    std::free(ptr);
+}
+
+} // namespace memory_usage
+
+// operator new allocates by malloc, so freeing its memory is not a mismatch
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    return memory_usage::Allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return memory_usage::Allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return memory_usage::Allocate(size, alignof(std::max_align_t));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return memory_usage::Allocate(size, static_cast<size_t>(alignment));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    memory_usage::Deallocate(ptr);
+}
+
+#pragma GCC diagnostic pop